@@ -1,22 +1,158 @@
 #include <iostream>
 #include <string>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// События боя передаются приёмнику; вывод в консоль - только один из приёмников.
+// Симуляция только создаёт небольшие записи; текст собирается приёмником позже
+enum class CombatEventType : std::uint8_t {
+    ATTACK,
+    NO_EFFECT,
+    DEFEAT
+};
+
+// Участники записываются номерами имён из combatNameId; value - урон
+struct CombatEvent {
+    CombatEventType type;
+    std::uint32_t source;
+    std::uint32_t target;
+    std::int32_t value;
+};
+
+// Таблица имён участников боя: одно имя - один номер на всё время работы программы.
+// Таблица под мьютексом, как и приёмник, привязанный к потоку; deque не перемещает строки
+// при росте, и ссылка из combatName остаётся действительной после разблокировки
+struct CombatNameTable {
+    std::mutex mtx;
+    std::deque<std::string> names;
+    std::unordered_map<std::string, std::uint32_t> ids;
+};
+
+CombatNameTable& combatNames() {
+    static CombatNameTable table;
+    return table;
+}
+
+std::uint32_t combatNameId(const std::string& name) {
+    CombatNameTable& table = combatNames();
+    std::lock_guard<std::mutex> lock(table.mtx);
+    auto [it, inserted] = table.ids.try_emplace(name, static_cast<std::uint32_t>(table.names.size()));
+    if (inserted) table.names.push_back(name);
+    return it->second;
+}
+
+const std::string& combatName(std::uint32_t id) {
+    CombatNameTable& table = combatNames();
+    std::lock_guard<std::mutex> lock(table.mtx);
+    return table.names[id];
+}
+
+class CombatSink {
+public:
+    virtual ~CombatSink() = default;
+    virtual void emit(const CombatEvent& event) = 0;
+    virtual void flush() {}
+};
+
+// Безголовый режим: события отбрасываются, форматирования нет совсем
+class NullCombatSink : public CombatSink {
+public:
+    void emit(const CombatEvent&) override {}
+};
+
+// Текст для консоли: события копятся в буфере и форматируются пачкой при flush()
+// или при заполнении буфера, одной записью в поток
+class TextCombatSink : public CombatSink {
+    std::ostream& out;
+    std::vector<CombatEvent> pending;
+    std::size_t capacity;
+
+    static void render(std::string& text, const CombatEvent& e) {
+        const std::string& source = combatName(e.source);
+        const std::string& target = combatName(e.target);
+        switch (e.type) {
+            case CombatEventType::ATTACK:
+                text += source + " attacks " + target + " for " + std::to_string(e.value) + " damage!\n";
+                break;
+            case CombatEventType::NO_EFFECT: text += source + " attacks " + target + ", but it has no effect!\n"; break;
+            case CombatEventType::DEFEAT: text += target + " has been defeated!\n"; break;
+        }
+    }
+
+public:
+    explicit TextCombatSink(std::ostream& out, std::size_t capacity = 256) : out(out), capacity(capacity) {
+        pending.reserve(capacity);
+    }
+
+    ~TextCombatSink() override { flush(); }
+
+    void emit(const CombatEvent& event) override {
+        pending.push_back(event);
+        if (pending.size() >= capacity) flush();
+    }
+
+    void flush() override {
+        if (pending.empty()) return;
+        std::string text;
+        for (const auto& event : pending) render(text, event);
+        pending.clear();
+        out << text << std::flush;
+    }
+};
+
+// Приёмник событий текущего потока; по умолчанию - буферизованный текст в std::cout
+CombatSink*& currentCombatSink() {
+    static TextCombatSink console(std::cout);
+    thread_local CombatSink* sink = &console;
+    return sink;
+}
+
+CombatSink& combatSink() {
+    return *currentCombatSink();
+}
+
+// Подменяет приёмник на время жизни объекта
+class ScopedCombatSink {
+    CombatSink* previous;
+
+public:
+    explicit ScopedCombatSink(CombatSink& sink) : previous(std::exchange(currentCombatSink(), &sink)) {}
+    ~ScopedCombatSink() { currentCombatSink() = previous; }
+    ScopedCombatSink(const ScopedCombatSink&) = delete;
+    ScopedCombatSink& operator=(const ScopedCombatSink&) = delete;
+};
 
 class Character {
 private:
     std::string name;
+    std::uint32_t nameId;
     int health;
     int attack;
     int defense;
 
 public:
     Character(const std::string& n, int h, int a, int d)
-        : name(n), health(h), attack(a), defense(d) {}
+        : name(n), nameId(combatNameId(n)), health(h), attack(a), defense(d) {}
 
     int getHealth() const {
         return health;
     }
 
+    const std::string& getName() const {
+        return name;
+    }
+
+    // Описание печатается сразу, поэтому накопленный текст боя выводится перед ним
     void displayInfo() const {
+        combatSink().flush();
         std::cout << "Name: " << name << ", HP: " << health
                   << ", Attack: " << attack << ", Defense: " << defense << std::endl;
     }
@@ -25,9 +161,12 @@ public:
         int damage = attack - enemy.defense;
         if (damage > 0) {
             enemy.health -= damage;
-            std::cout << name << " attacks " << enemy.name << " for " << damage << " damage!" << std::endl;
+            combatSink().emit({CombatEventType::ATTACK, nameId, enemy.nameId, damage});
         } else {
-            std::cout << name << " attacks " << enemy.name << ", but it has no effect!" << std::endl;
+            combatSink().emit({CombatEventType::NO_EFFECT, nameId, enemy.nameId, 0});
+        }
+        if (enemy.health <= 0) {
+            combatSink().emit({CombatEventType::DEFEAT, nameId, enemy.nameId, 0});
         }
     }
 
@@ -46,7 +185,51 @@ public:
     }
 };
 
-int main() {
+// Число из командной строки: десятичное без знака и лишних символов, как parseNumber в lab1.3.cpp
+std::optional<std::uint64_t> parseNumber(const char* text) {
+    std::uint64_t value = 0;
+    const char* end = text + std::strlen(text);
+    auto [ptr, error] = std::from_chars(text, end, value);
+    if (error != std::errc() || ptr != end || ptr == text) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Бои без консоли: события отбрасываются приёмником, текст не собирается совсем
+void runHeadless(std::uint64_t battleCount) {
+    NullCombatSink headless;
+    ScopedCombatSink quiet(headless);
+    std::uint64_t wins = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < battleCount; ++i) {
+        Character hero("Hero", 100, 20, 10);
+        Character monster("Goblin", 50 + static_cast<int>(i % 100), 15 + static_cast<int>(i % 10), 5);
+        while (true) {
+            hero.attackEnemy(monster);
+            if (monster.getHealth() <= 0) {
+                ++wins;
+                break;
+            }
+            monster.attackEnemy(hero);
+            if (hero.getHealth() <= 0) break;
+        }
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << battleCount << " боёв без вывода: побед героя " << wins << ", " << ms << " мс" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--headless") == 0) {
+        std::optional<std::uint64_t> count = argc > 2 ? parseNumber(argv[2]) : std::optional<std::uint64_t>(100'000);
+        if (!count) {
+            std::cerr << "Использование: " << argv[0] << " [--headless [n]]" << std::endl;
+            return 1;
+        }
+        runHeadless(*count);
+        return 0;
+    }
+
     Character hero("Hero", 100, 20, 10);
     Character monster("Goblin", 50, 15, 5);
 
@@ -2,40 +2,292 @@
 #include <string>
 #include <ctime>
 #include <cstdlib>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Генератор боевой случайности xoshiro256**. Состояние хранится в объекте, поэтому
+// у каждого потока или боя свой генератор без общей блокировки, а одно и то же зерно
+// (и номер потока stream) всегда даёт одну и ту же последовательность бросков
+class CombatRng {
+private:
+    std::array<std::uint64_t, 4> state;
+
+    static std::uint64_t splitMix(std::uint64_t& x) {
+        std::uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    explicit CombatRng(std::uint64_t seed, std::uint64_t stream = 0) {
+        std::uint64_t streamKey = stream;
+        std::uint64_t x = seed ^ splitMix(streamKey);
+        for (auto& word : state) {
+            word = splitMix(x);
+        }
+    }
+
+    std::uint64_t next() {
+        const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Равномерное число из [0, bound) без смещения остатка от деления (метод Лемира)
+    std::uint32_t below(std::uint32_t bound) {
+        std::uint64_t m = (next() >> 32) * bound;
+        auto low = static_cast<std::uint32_t>(m);
+        if (low < bound) {
+            const std::uint32_t threshold = -bound % bound;
+            while (low < threshold) {
+                m = (next() >> 32) * bound;
+                low = static_cast<std::uint32_t>(m);
+            }
+        }
+        return static_cast<std::uint32_t>(m >> 32);
+    }
+
+    // Пачка бросков [0, bound) для пакетной обработки атак; bound не шире байта броска
+    void fillRolls(std::uint8_t* out, std::size_t n, std::uint8_t bound = 100) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = static_cast<std::uint8_t>(below(bound));
+        }
+    }
+};
+
+// Генератор текущего потока; seedCombatRng делает следующие бои потока воспроизводимыми
+CombatRng& combatRng() {
+    thread_local CombatRng rng(static_cast<std::uint64_t>(std::time(nullptr)),
+                               std::hash<std::thread::id>()(std::this_thread::get_id()));
+    return rng;
+}
+
+void seedCombatRng(std::uint64_t seed, std::uint64_t stream = 0) {
+    combatRng() = CombatRng(seed, stream);
+}
+
+// Число из командной строки (зерно, размер): десятичное без знака и лишних символов
+std::optional<std::uint64_t> parseNumber(const char* text) {
+    std::uint64_t value = 0;
+    const char* end = text + std::strlen(text);
+    auto [ptr, error] = std::from_chars(text, end, value);
+    if (error != std::errc() || ptr != end || ptr == text) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// События боя передаются приёмнику текущего потока: демонстрация печатает их,
+// а замеры и проверки подставляют NullCombatSink вместо отключения std::cout.
+// Симуляция только создаёт небольшие записи; текст собирается приёмником позже
+enum class CombatEventType : std::uint8_t {
+    ATTACK,
+    NO_EFFECT,
+    CRIT,
+    POISON,
+    SPECIAL,
+    HEAL,
+    REMARK,
+    DEFEAT
+};
+
+// Участники записываются номерами имён из combatNameId, поэтому событие можно хранить
+// в буфере дольше, чем живут сами участники
+struct CombatEvent {
+    CombatEventType type;
+    std::uint32_t source;
+    std::uint32_t target;
+    std::int32_t value;  // урон или лечение
+    std::int32_t health; // здоровье цели после события
+    std::uint32_t note;  // номер строки из combatNameId: удар у SPECIAL, реплика у REMARK
+};
+
+// Таблица имён участников боя: одно имя - один номер на всё время работы программы.
+// Сущности могут создаваться в разных потоках, поэтому таблица под мьютексом; deque не
+// перемещает строки при росте, и ссылка из combatName остаётся действительной после разблокировки
+struct CombatNameTable {
+    std::mutex mtx;
+    std::deque<std::string> names;
+    std::unordered_map<std::string, std::uint32_t> ids;
+};
+
+CombatNameTable& combatNames() {
+    static CombatNameTable table;
+    return table;
+}
+
+std::uint32_t combatNameId(const std::string& name) {
+    CombatNameTable& table = combatNames();
+    std::lock_guard<std::mutex> lock(table.mtx);
+    auto [it, inserted] = table.ids.try_emplace(name, static_cast<std::uint32_t>(table.names.size()));
+    if (inserted) table.names.push_back(name);
+    return it->second;
+}
+
+const std::string& combatName(std::uint32_t id) {
+    CombatNameTable& table = combatNames();
+    std::lock_guard<std::mutex> lock(table.mtx);
+    return table.names[id];
+}
+
+class CombatSink {
+public:
+    virtual ~CombatSink() = default;
+    virtual void emit(const CombatEvent& event) = 0;
+    virtual void flush() {}
+};
+
+// Безголовый режим: события отбрасываются, форматирования нет совсем
+class NullCombatSink : public CombatSink {
+public:
+    void emit(const CombatEvent&) override {}
+};
+
+// Текст для консоли: события копятся в буфере и форматируются пачкой при flush()
+// или при заполнении буфера, одной записью в поток
+class TextCombatSink : public CombatSink {
+    std::ostream& out;
+    std::vector<CombatEvent> pending;
+    std::size_t capacity;
+
+    static void render(std::string& text, const CombatEvent& e) {
+        const std::string& source = combatName(e.source);
+        const std::string& target = combatName(e.target);
+        const std::string hit = source + " attacks " + target + " for " + std::to_string(e.value) + " damage!\n";
+        switch (e.type) {
+            case CombatEventType::ATTACK: text += hit; break;
+            case CombatEventType::NO_EFFECT: text += source + " attacks " + target + ", but it has no effect!\n"; break;
+            case CombatEventType::CRIT: text += "Critical hit! " + hit; break;
+            case CombatEventType::POISON: text += "Poisonous attack! " + hit; break;
+            case CombatEventType::SPECIAL: text += combatName(e.note) + "! " + hit; break;
+            case CombatEventType::HEAL:
+                text += target + " heals for " + std::to_string(e.value) + " HP. Current HP: " + std::to_string(e.health) + "\n";
+                break;
+            case CombatEventType::REMARK: text += "(" + combatName(e.note) + ")\n"; break;
+            case CombatEventType::DEFEAT: text += target + " has been defeated!\n"; break;
+        }
+    }
+
+public:
+    explicit TextCombatSink(std::ostream& out, std::size_t capacity = 256) : out(out), capacity(capacity) {
+        pending.reserve(capacity);
+    }
+
+    ~TextCombatSink() override { flush(); }
+
+    void emit(const CombatEvent& event) override {
+        pending.push_back(event);
+        if (pending.size() >= capacity) flush();
+    }
+
+    void flush() override {
+        if (pending.empty()) return;
+        std::string text;
+        for (const auto& event : pending) render(text, event);
+        pending.clear();
+        out << text << std::flush;
+    }
+};
+
+// Приёмник событий текущего потока; по умолчанию - буферизованный текст в std::cout
+CombatSink*& currentCombatSink() {
+    static TextCombatSink console(std::cout);
+    thread_local CombatSink* sink = &console;
+    return sink;
+}
+
+CombatSink& combatSink() {
+    return *currentCombatSink();
+}
+
+// Подменяет приёмник на время жизни объекта
+class ScopedCombatSink {
+    CombatSink* previous;
+
+public:
+    explicit ScopedCombatSink(CombatSink& sink) : previous(std::exchange(currentCombatSink(), &sink)) {}
+    ~ScopedCombatSink() { currentCombatSink() = previous; }
+    ScopedCombatSink(const ScopedCombatSink&) = delete;
+    ScopedCombatSink& operator=(const ScopedCombatSink&) = delete;
+};
 
 class Entity {
 protected:
     std::string name;
+    std::uint32_t nameId;
     int health;
     int attackPower;
     int defense;
 
+    // Событие удара; после него - поражение, если у цели не осталось здоровья
+    void emitHit(CombatEventType type, const Entity& target, int damage, std::uint32_t note = 0) const {
+        combatSink().emit({type, nameId, target.nameId, damage, target.health, note});
+        if (target.health <= 0) {
+            combatSink().emit({CombatEventType::DEFEAT, nameId, target.nameId, 0, target.health, 0});
+        }
+    }
+
 public:
     Entity(const std::string& n, int h, int a, int d)
-        : name(n), health(h), attackPower(a), defense(d) {}
+        : name(n), nameId(combatNameId(n)), health(h), attackPower(a), defense(d) {}
+
+    void takeDamage(int damage) { health -= damage; }
+    const std::string& getName() const { return name; }
+    int getDefense() const { return defense; }
+    int getHealth() const { return health; }
 
     // Виртуальный метод для атаки
     virtual void attack(Entity& target) {
         int damage = attackPower - target.defense;
         if (damage > 0) {
             target.health -= damage;
-            std::cout << name << " attacks " << target.name << " for " << damage << " damage!\n";
+            emitHit(CombatEventType::ATTACK, target, damage);
         } else {
-            std::cout << name << " attacks " << target.name << ", but it has no effect!\n";
+            emitHit(CombatEventType::NO_EFFECT, target, 0);
         }
     }
 
-    // Виртуальный метод для вывода информации
-    virtual void displayInfo() const {
-        std::cout << "Entity: " << name << ", HP: " << health
-                  << ", Attack: " << attackPower << ", Defense: " << defense << std::endl;
+    // Виртуальный метод для описания сущности
+    virtual void describe(std::ostream& out) const {
+        out << "Entity: " << name << ", HP: " << health
+            << ", Attack: " << attackPower << ", Defense: " << defense << std::endl;
+    }
+
+    // Описание печатается сразу, поэтому накопленный текст боя выводится перед ним
+    void displayInfo() const {
+        combatSink().flush();
+        describe(std::cout);
     }
 
     // Виртуальный метод для лечения (задание 3)
     virtual void heal(int amount) {
         health += amount;
         if (health > 100) health = 100; // Максимальное здоровье
-        std::cout << name << " heals for " << amount << " HP. Current HP: " << health << std::endl;
+        combatSink().emit({CombatEventType::HEAL, nameId, nameId, amount, health, 0});
     }
 
     virtual ~Entity() {}
@@ -47,27 +299,29 @@ public:
         : Entity(n, h, a, d) {}
 
     void attack(Entity& target) override {
-        int damage = attackPower - target.defense;
+        int damage = attackPower - target.getDefense();
         if (damage > 0) {
-            if (rand() % 100 < 20) { // 20% шанс крита
+            CombatEventType type = CombatEventType::ATTACK;
+            if (combatRng().below(100) < 20) { // 20% шанс крита
                 damage *= 2;
-                std::cout << "Critical hit! ";
+                type = CombatEventType::CRIT;
             }
-            target.health -= damage;
-            std::cout << name << " attacks " << target.name << " for " << damage << " damage!\n";
+            target.takeDamage(damage);
+            emitHit(type, target, damage);
         } else {
-            std::cout << name << " attacks " << target.name << ", but it has no effect!\n";
+            emitHit(CombatEventType::NO_EFFECT, target, 0);
         }
     }
 
     void heal(int amount) override { // Задание 3 (переопределение)
         Entity::heal(amount); // Используем базовую реализацию
-        std::cout << "(Character's healing powers are strong!)\n";
+        static const std::uint32_t remark = combatNameId("Character's healing powers are strong!");
+        combatSink().emit({CombatEventType::REMARK, nameId, nameId, 0, health, remark});
     }
 
-    void displayInfo() const override {
-        std::cout << "Character: " << name << ", HP: " << health
-                  << ", Attack: " << attackPower << ", Defense: " << defense << std::endl;
+    void describe(std::ostream& out) const override {
+        out << "Character: " << name << ", HP: " << health
+            << ", Attack: " << attackPower << ", Defense: " << defense << std::endl;
     }
 };
 
@@ -77,22 +331,23 @@ public:
         : Entity(n, h, a, d) {}
 
     void attack(Entity& target) override {
-        int damage = attackPower - target.defense;
+        int damage = attackPower - target.getDefense();
         if (damage > 0) {
-            if (rand() % 100 < 30) { // 30% шанс яда
+            CombatEventType type = CombatEventType::ATTACK;
+            if (combatRng().below(100) < 30) { // 30% шанс яда
                 damage += 5;
-                std::cout << "Poisonous attack! ";
+                type = CombatEventType::POISON;
             }
-            target.health -= damage;
-            std::cout << name << " attacks " << target.name << " for " << damage << " damage!\n";
+            target.takeDamage(damage);
+            emitHit(type, target, damage);
         } else {
-            std::cout << name << " attacks " << target.name << ", but it has no effect!\n";
+            emitHit(CombatEventType::NO_EFFECT, target, 0);
         }
     }
 
-    void displayInfo() const override {
-        std::cout << "Monster: " << name << ", HP: " << health
-                  << ", Attack: " << attackPower << ", Defense: " << defense << std::endl;
+    void describe(std::ostream& out) const override {
+        out << "Monster: " << name << ", HP: " << health
+            << ", Attack: " << attackPower << ", Defense: " << defense << std::endl;
     }
 };
 
@@ -100,35 +355,358 @@ public:
 class Boss : public Monster {
 private:
     std::string specialAbility;
+    std::uint32_t specialAbilityId;
 
 public:
     Boss(const std::string& n, int h, int a, int d, const std::string& sa)
-        : Monster(n, h, a, d), specialAbility(sa) {}
+        : Monster(n, h, a, d), specialAbility(sa), specialAbilityId(combatNameId(sa)) {}
 
     // Задание 2: Переопределение attack
     void attack(Entity& target) override {
-        int damage = attackPower - target.defense;
+        int damage = attackPower - target.getDefense();
         if (damage > 0) {
-            if (rand() % 100 < 25) { // 25% шанс огненного удара
+            if (combatRng().below(100) < 25) { // 25% шанс огненного удара
                 damage += 10;
-                std::cout << specialAbility << "! ";
+                target.takeDamage(damage);
+                emitHit(CombatEventType::SPECIAL, target, damage, specialAbilityId);
+            } else {
+                target.takeDamage(damage);
+                emitHit(CombatEventType::ATTACK, target, damage);
             }
-            target.health -= damage;
-            std::cout << name << " attacks " << target.name << " for " << damage << " damage!\n";
         } else {
-            std::cout << name << " attacks " << target.name << ", but it has no effect!\n";
+            emitHit(CombatEventType::NO_EFFECT, target, 0);
         }
     }
 
-    void displayInfo() const override {
-        std::cout << "Boss: " << name << ", HP: " << health
-                  << ", Attack: " << attackPower << ", Defense: " << defense 
-                  << ", Ability: " << specialAbility << std::endl;
+    void describe(std::ostream& out) const override {
+        out << "Boss: " << name << ", HP: " << health
+            << ", Attack: " << attackPower << ", Defense: " << defense 
+            << ", Ability: " << specialAbility << std::endl;
     }
 };
 
-int main() {
-    srand(static_cast<unsigned>(time(0)));
+// Данно-ориентированное хранилище боевых сущностей: здоровье, атака и защита
+// лежат в отдельных непрерывных массивах по номеру сущности, а вместо иерархии
+// классов у каждой сущности есть тег архетипа, выбирающий правило особого удара.
+enum class Archetype : std::uint8_t {
+    CHARACTER,
+    MONSTER,
+    BOSS
+};
+
+using EntityId = std::uint32_t;
+
+// Особый удар архетипа: при броске меньше chance урон становится damage * multiplier + bonus
+struct ArchetypeRule {
+    int chance;
+    int multiplier;
+    int bonus;
+};
+
+constexpr std::array<ArchetypeRule, 3> archetypeRules = {{
+    {20, 2, 0},  // CHARACTER: критический удар
+    {30, 1, 5},  // MONSTER: ядовитая атака
+    {25, 1, 10}, // BOSS: особая способность
+}};
+
+class CombatStore {
+private:
+    std::vector<int> health;
+    std::vector<int> attackPower;
+    std::vector<int> defense;
+    std::vector<Archetype> archetype;
+    std::vector<std::string> names; // Холодные данные, в бою не читаются
+
+public:
+    void reserve(std::size_t count) {
+        health.reserve(count);
+        attackPower.reserve(count);
+        defense.reserve(count);
+        archetype.reserve(count);
+        names.reserve(count);
+    }
+
+    EntityId spawn(Archetype type, const std::string& name, int h, int a, int d) {
+        health.push_back(h);
+        attackPower.push_back(a);
+        defense.push_back(d);
+        archetype.push_back(type);
+        names.push_back(name);
+        return static_cast<EntityId>(health.size() - 1);
+    }
+
+    // Разрешает n атак attackers[i] -> targets[i] одним циклом по тем же правилам,
+    // что и Entity::attack у соответствующих классов (проверяется в --check-store).
+    // rolls[i] - бросок 0..99 для особого удара.
+    void resolveAttacks(const EntityId* attackers, const EntityId* targets, const std::uint8_t* rolls, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const EntityId a = attackers[i];
+            const EntityId t = targets[i];
+            int damage = attackPower[a] - defense[t];
+            if (damage > 0) {
+                const ArchetypeRule& rule = archetypeRules[static_cast<std::size_t>(archetype[a])];
+                if (rolls[i] < rule.chance) {
+                    damage = damage * rule.multiplier + rule.bonus;
+                }
+                health[t] -= damage;
+            }
+        }
+    }
+
+    std::size_t size() const { return health.size(); }
+    int getHealth(EntityId id) const { return health[id]; }
+    const std::string& getName(EntityId id) const { return names[id]; }
+};
+
+// Одинаковый состав для обоих путей: каждая третья сущность - монстр, каждая десятая - босс.
+// Защита растёт до defenseSpread + 4; при разбросе больше 10 часть атак не наносит урона
+void spawnMixed(std::size_t count, int defenseSpread, std::vector<std::unique_ptr<Entity>>& objects, CombatStore& store) {
+    objects.reserve(count);
+    store.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Archetype type = i % 10 == 0 ? Archetype::BOSS : (i % 3 == 0 ? Archetype::MONSTER : Archetype::CHARACTER);
+        const int h = 100 + static_cast<int>(i % 50);
+        const int a = 15 + static_cast<int>(i % 20);
+        const int d = 5 + static_cast<int>(i % static_cast<std::size_t>(defenseSpread));
+        switch (type) {
+            case Archetype::CHARACTER: objects.push_back(std::make_unique<Character>("Hero", h, a, d)); break;
+            case Archetype::MONSTER: objects.push_back(std::make_unique<Monster>("Goblin", h, a, d)); break;
+            case Archetype::BOSS: objects.push_back(std::make_unique<Boss>("Dragon", h, a, d, "Fire Breath")); break;
+        }
+        store.spawn(type, "", h, a, d);
+    }
+}
+
+void benchmarkCombatStore(std::size_t count) {
+    std::vector<EntityId> attackers(count);
+    std::vector<EntityId> targets(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        attackers[i] = static_cast<EntityId>(i);
+        targets[i] = static_cast<EntityId>((i * 7919 + 1) % count);
+    }
+
+    std::vector<std::unique_ptr<Entity>> objects;
+    CombatStore store;
+    spawnMixed(count, 10, objects, store);
+
+    // События виртуального пути отбрасываются, чтобы сравнивать сами вычисления, а не консоль
+    NullCombatSink discard;
+    ScopedCombatSink quiet(discard);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        objects[attackers[i]]->attack(*objects[targets[i]]);
+    }
+    const double virtualMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::uint8_t> rolls(count);
+    combatRng().fillRolls(rolls.data(), count);
+    const double rollMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    store.resolveAttacks(attackers.data(), targets.data(), rolls.data(), count);
+    const double storeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << count << " атак, виртуальные вызовы: " << virtualMs << " мс" << std::endl;
+    std::cout << count << " атак, CombatStore: " << storeMs << " мс (+ " << rollMs << " мс на броски)" << std::endl;
+
+    // Прежние броски через глобальный rand() для сравнения
+    start = std::chrono::steady_clock::now();
+    for (auto& roll : rolls) {
+        roll = static_cast<std::uint8_t>(std::rand() % 100);
+    }
+    const double randMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << count << " бросков: rand() % 100 - " << randMs << " мс, CombatRng - " << rollMs << " мс" << std::endl;
+}
+
+// CombatStore::resolveAttacks должен совпадать с виртуальными Entity::attack. Перед каждой
+// виртуальной атакой генератор потока пересеивается (seed, i), а в пакет идёт первый бросок
+// такого же генератора: атака, дошедшая до броска, получает то же число, что и пакет
+bool checkCombatStore(std::uint64_t seed) {
+    const std::size_t count = 3000;
+    const std::size_t attackCount = count * 8;
+    std::vector<std::unique_ptr<Entity>> objects;
+    CombatStore store;
+    spawnMixed(count, 30, objects, store);
+
+    std::vector<EntityId> attackers(attackCount);
+    std::vector<EntityId> targets(attackCount);
+    std::vector<std::uint8_t> rolls(attackCount);
+    for (std::size_t i = 0; i < attackCount; ++i) {
+        attackers[i] = static_cast<EntityId>(i % count);
+        targets[i] = static_cast<EntityId>((i * 7919 + 1) % count);
+        rolls[i] = static_cast<std::uint8_t>(CombatRng(seed, i).below(100));
+    }
+
+    {
+        NullCombatSink discard;
+        ScopedCombatSink quiet(discard);
+        for (std::size_t i = 0; i < attackCount; ++i) {
+            seedCombatRng(seed, i);
+            objects[attackers[i]]->attack(*objects[targets[i]]);
+        }
+    }
+    store.resolveAttacks(attackers.data(), targets.data(), rolls.data(), attackCount);
+
+    std::size_t mismatches = 0;
+    for (EntityId id = 0; id < count; ++id) {
+        mismatches += objects[id]->getHealth() != store.getHealth(id);
+    }
+    if (mismatches == 0) {
+        std::cout << "CombatStore совпадает с Entity::attack на " << attackCount << " атаках" << std::endl;
+    } else {
+        std::cout << "CombatStore: здоровье расходится у " << mismatches << " сущностей" << std::endl;
+    }
+    return mismatches == 0;
+}
+
+// Броски для пачки атак, поделённой на блоки: у блока свой поток генератора (seed, номер блока),
+// поэтому результат не зависит от того, сколько потоков и в каком порядке обрабатывают блоки
+std::vector<std::uint8_t> parallelRolls(std::uint64_t seed, std::size_t count, std::size_t threadCount) {
+    const std::size_t blockSize = 4096;
+    const std::size_t blocks = (count + blockSize - 1) / blockSize;
+    std::vector<std::uint8_t> rolls(count);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            for (std::size_t block = t; block < blocks; block += threadCount) {
+                CombatRng rng(seed, block);
+                const std::size_t begin = block * blockSize;
+                rng.fillRolls(rolls.data() + begin, std::min(blockSize, count - begin));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return rolls;
+}
+
+// Воспроизводимость: одно зерно - одинаковые броски при любом числе потоков,
+// одинаковые бои при повторе, и равномерность бросков без смещения
+bool checkCombatRng(std::uint64_t seed) {
+    const std::size_t count = 1'000'000;
+    const std::vector<std::uint8_t> single = parallelRolls(seed, count, 1);
+    bool ok = parallelRolls(seed, count, 4) == single && parallelRolls(seed, count, 7) == single;
+
+    auto replay = [seed] {
+        seedCombatRng(seed);
+        Character hero("Hero", 100, 20, 10);
+        Boss dragon("Dragon", 200, 30, 20, "Fire Breath");
+        NullCombatSink discard;
+        ScopedCombatSink quiet(discard);
+        for (int i = 0; i < 50; ++i) {
+            hero.attack(dragon);
+            dragon.attack(hero);
+        }
+        return std::array<int, 2>{hero.getHealth(), dragon.getHealth()};
+    };
+    ok = ok && replay() == replay();
+
+    std::array<std::size_t, 100> histogram{};
+    for (std::uint8_t roll : single) {
+        ++histogram[roll];
+    }
+    const auto [least, most] = std::minmax_element(histogram.begin(), histogram.end());
+    ok = ok && *least > count / 100 * 95 / 100 && *most < count / 100 * 105 / 100;
+
+    std::cout << (ok ? "CombatRng воспроизводим при любом числе потоков" : "CombatRng: расхождение") << std::endl;
+    return ok;
+}
+
+// Бои без консоли: события отбрасываются приёмником, текст не собирается совсем
+void runHeadless(std::size_t battleCount) {
+    NullCombatSink headless;
+    ScopedCombatSink quiet(headless);
+    std::size_t wins = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < battleCount; ++i) {
+        Character hero("Hero", 100, 20 + static_cast<int>(combatRng().below(5)), 10);
+        std::unique_ptr<Entity> enemy;
+        if (combatRng().below(4) == 0) {
+            enemy = std::make_unique<Boss>("Dragon", 200, 30, 20, "Fire Breath");
+        } else {
+            enemy = std::make_unique<Monster>("Goblin", 50, 15, 5);
+        }
+        while (true) {
+            hero.attack(*enemy);
+            if (enemy->getHealth() <= 0) {
+                ++wins;
+                break;
+            }
+            enemy->attack(hero);
+            if (hero.getHealth() <= 0) break;
+        }
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << battleCount << " боёв без вывода: побед героя " << wins << ", " << ms << " мс" << std::endl;
+}
+
+// Участники демонстрации в CombatStore: те же атаки пачкой без виртуальных вызовов.
+// Броски у пачки свои, поэтому здоровье может отличаться от демонстрации с объектами
+void demoCombatStore() {
+    CombatStore store;
+    EntityId storeHero = store.spawn(Archetype::CHARACTER, "Hero", 100, 20, 10);
+    EntityId storeGoblin = store.spawn(Archetype::MONSTER, "Goblin", 50, 15, 5);
+    EntityId storeDragon = store.spawn(Archetype::BOSS, "Dragon", 200, 30, 20);
+    const EntityId attackers[] = { storeHero, storeDragon, storeGoblin };
+    const EntityId targets[] = { storeGoblin, storeHero, storeHero };
+    std::uint8_t rolls[3];
+    combatRng().fillRolls(rolls, 3);
+    store.resolveAttacks(attackers, targets, rolls, 3);
+    for (EntityId id = 0; id < store.size(); ++id) {
+        std::cout << store.getName(id) << " HP: " << store.getHealth(id) << std::endl;
+    }
+}
+
+int usage(const char* program) {
+    std::cerr << "Использование: " << program
+              << " [--bench [n] | --headless [n] | --check-rng [зерно] | --check-store [зерно] | --store-demo | --seed зерно]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        std::optional<std::uint64_t> count = argc > 2 ? parseNumber(argv[2]) : std::optional<std::uint64_t>(1'000'000);
+        if (!count || *count == 0) {
+            return usage(argv[0]);
+        }
+        benchmarkCombatStore(*count);
+        return 0;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--headless") == 0) {
+        std::optional<std::uint64_t> count = argc > 2 ? parseNumber(argv[2]) : std::optional<std::uint64_t>(100'000);
+        if (!count) {
+            return usage(argv[0]);
+        }
+        runHeadless(*count);
+        return 0;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--check-rng") == 0) {
+        std::optional<std::uint64_t> seed = argc > 2 ? parseNumber(argv[2]) : std::optional<std::uint64_t>(2024);
+        if (!seed) {
+            return usage(argv[0]);
+        }
+        return checkCombatRng(*seed) ? 0 : 1;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--check-store") == 0) {
+        std::optional<std::uint64_t> seed = argc > 2 ? parseNumber(argv[2]) : std::optional<std::uint64_t>(2024);
+        if (!seed) {
+            return usage(argv[0]);
+        }
+        return checkCombatStore(*seed) ? 0 : 1;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--store-demo") == 0) {
+        demoCombatStore();
+        return 0;
+    }
+    // --seed N повторяет тот же бой
+    if (argc > 1 && std::strcmp(argv[1], "--seed") == 0) {
+        std::optional<std::uint64_t> seed = argc > 2 ? parseNumber(argv[2]) : std::nullopt;
+        if (!seed) {
+            return usage(argv[0]);
+        }
+        seedCombatRng(*seed);
+    }
 
     Character hero("Hero", 100, 20, 10);
     Monster goblin("Goblin", 50, 15, 5);
@@ -7,6 +7,30 @@
 #include <string>
 #include <limits>
 #include <cctype>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include <random>
+#include <span>
+#include <utility>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <optional>
+#include <charconv>
+#include <ctime>
+#include <sstream>
 
 // Уровни доступа
 enum class AccessLevel {
@@ -16,6 +40,183 @@ enum class AccessLevel {
     ADMIN
 };
 
+// Тип пользователя в колоночном хранилище, журнале и бинарном снимке
+enum class UserType : std::uint8_t {
+    STUDENT = 1,
+    TEACHER,
+    ADMINISTRATOR
+};
+
+const char* accessLevelName(AccessLevel level) {
+    switch(level) {
+        case AccessLevel::STUDENT: return "Студент";
+        case AccessLevel::TEACHER: return "Преподаватель";
+        case AccessLevel::ADMIN: return "Администратор";
+        default: return "Нет доступа";
+    }
+}
+
+AccessLevel accessLevelOf(UserType type) {
+    switch(type) {
+        case UserType::STUDENT: return AccessLevel::STUDENT;
+        case UserType::TEACHER: return AccessLevel::TEACHER;
+        case UserType::ADMINISTRATOR: return AccessLevel::ADMIN;
+    }
+    throw std::invalid_argument("Неизвестный тип пользователя");
+}
+
+std::string_view userTypeName(UserType type) {
+    switch(type) {
+        case UserType::STUDENT: return "Student";
+        case UserType::TEACHER: return "Teacher";
+        case UserType::ADMINISTRATOR: return "Administrator";
+    }
+    throw std::invalid_argument("Неизвестный тип пользователя");
+}
+
+std::optional<UserType> userTypeFromName(std::string_view name) {
+    if (name == "Student") return UserType::STUDENT;
+    if (name == "Teacher") return UserType::TEACHER;
+    if (name == "Administrator") return UserType::ADMINISTRATOR;
+    return std::nullopt;
+}
+
+// Временное окно доступа: дни недели (бит 0 — понедельник) и минуты суток [from, to).
+// Окно с from > to переходит через полночь; день недели берется по текущим суткам
+struct TimeWindow {
+    std::uint8_t days = 0x7F;
+    std::uint16_t from = 0;
+    std::uint16_t to = 24 * 60;
+
+    bool contains(std::chrono::system_clock::time_point when) const {
+        std::time_t time = std::chrono::system_clock::to_time_t(when);
+        std::tm local{};
+        localtime_r(&time, &local);
+        int weekday = (local.tm_wday + 6) % 7;
+        int minute = local.tm_hour * 60 + local.tm_min;
+        if (!((days >> weekday) & 1)) return false;
+        return from <= to ? minute >= from && minute < to : minute >= from || minute < to;
+    }
+};
+
+// Политика доступа к ресурсу. Правила проверяются по порядку: запрет пользователю,
+// временные окна, разрешение пользователю, разрешение группе, порядковое правило уровня.
+// Политика по умолчанию — только порядковое правило
+struct AccessPolicy {
+    std::vector<int> deniedUsers;
+    std::vector<int> allowedUsers;
+    std::vector<std::string> groups; // группы, кафедры или роли из дополнительной информации
+    std::vector<TimeWindow> windows; // пусто — без ограничений по времени
+    bool levelGrant = true;
+
+    bool isDefault() const {
+        return deniedUsers.empty() && allowedUsers.empty() && groups.empty() && windows.empty() && levelGrant;
+    }
+
+    // Решение без учета времени
+    bool grants(int userId, std::string_view info, AccessLevel level, AccessLevel required) const {
+        auto listed = [userId](const std::vector<int>& ids) {
+            return std::find(ids.begin(), ids.end(), userId) != ids.end();
+        };
+        if (listed(deniedUsers)) return false;
+        if (listed(allowedUsers)) return true;
+        if (std::find(groups.begin(), groups.end(), info) != groups.end()) return true;
+        return levelGrant && static_cast<int>(level) >= static_cast<int>(required);
+    }
+
+    bool open(std::chrono::system_clock::time_point when) const {
+        if (windows.empty()) return true;
+        return std::any_of(windows.begin(), windows.end(),
+            [when](const TimeWindow& window) { return window.contains(when); });
+    }
+};
+
+// Глобальная таблица интернированных строк: одинаковые строки (группы, кафедры, роли,
+// названия ресурсов) хранятся один раз и получают постоянный небольшой дескриптор.
+// Строки лежат блоками, которые не перемещаются, поэтому get() не берет блокировку.
+// Таблица только растет
+class StringInterner {
+public:
+    using Handle = std::uint32_t;
+
+private:
+    static constexpr std::size_t blockBits = 10;
+    static constexpr std::size_t blockSize = std::size_t{1} << blockBits;
+    static constexpr std::size_t maxBlocks = 4096;
+
+    std::array<std::atomic<std::string*>, maxBlocks> blocks{};
+    std::unordered_map<std::string_view, Handle> handles;
+    Handle count = 0;
+    std::size_t stringBytes = 0;
+    mutable std::mutex mtx;
+
+    StringInterner() = default;
+
+public:
+    ~StringInterner() {
+        for (auto& block : blocks) delete[] block.load();
+    }
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    static StringInterner& global() {
+        static StringInterner instance;
+        return instance;
+    }
+
+    Handle intern(std::string_view value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = handles.find(value);
+        if (it != handles.end()) return it->second;
+        if (count == blockSize * maxBlocks) {
+            throw std::runtime_error("Переполнение таблицы строк");
+        }
+
+        std::string* block = blocks[count >> blockBits].load(std::memory_order_relaxed);
+        if (!block) {
+            block = new std::string[blockSize];
+            blocks[count >> blockBits].store(block, std::memory_order_release);
+        }
+        std::string& slot = block[count & (blockSize - 1)];
+        slot.assign(value);
+        stringBytes += slot.capacity() + 1;
+        handles.emplace(slot, count);
+        return count++;
+    }
+
+    // Дескриптор уже интернированной строки без добавления новой
+    std::optional<Handle> find(std::string_view value) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = handles.find(value);
+        if (it == handles.end()) return std::nullopt;
+        return it->second;
+    }
+
+    const std::string& get(Handle handle) const {
+        return blocks[handle >> blockBits].load(std::memory_order_acquire)[handle & (blockSize - 1)];
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return count;
+    }
+
+    // Приблизительный объем памяти таблицы в байтах
+    std::size_t memoryUsage() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::size_t allocatedBlocks = (count + blockSize - 1) / blockSize;
+        return sizeof(*this) + allocatedBlocks * blockSize * sizeof(std::string) + stringBytes +
+               handles.bucket_count() * sizeof(void*) +
+               handles.size() * (sizeof(std::pair<const std::string_view, Handle>) + sizeof(void*) * 2);
+    }
+};
+
+void validateUser(std::string_view name, int id) {
+    if (name.empty()) throw std::invalid_argument("Имя не может быть пустым");
+    if (id <= 0) throw std::invalid_argument("ID должен быть положительным");
+}
+
 // Базовый класс пользователя
 class User {
 protected:
@@ -26,195 +227,2152 @@ protected:
 public:
     User(const std::string& name, int id, AccessLevel accessLevel)
         : name(name), id(id), accessLevel(accessLevel) {
-        if (name.empty()) throw std::invalid_argument("Имя не может быть пустым");
-        if (id <= 0) throw std::invalid_argument("ID должен быть положительным");
+        validateUser(name, id);
     }
 
     virtual ~User() = default;
 
-    std::string getName() const { return name; }
+    const std::string& getName() const { return name; }
     int getId() const { return id; }
     AccessLevel getAccessLevel() const { return accessLevel; }
 
     virtual void displayInfo() const {
-        std::cout << "Имя: " << name << "\nID: " << id << "\nУровень доступа: ";
-        switch(accessLevel) {
-            case AccessLevel::STUDENT: std::cout << "Студент\n"; break;
-            case AccessLevel::TEACHER: std::cout << "Преподаватель\n"; break;
-            case AccessLevel::ADMIN: std::cout << "Администратор\n"; break;
-            default: std::cout << "Нет доступа\n";
-        }
+        std::cout << "Имя: " << name << "\nID: " << id
+                  << "\nУровень доступа: " << accessLevelName(accessLevel) << "\n";
     }
 
-    virtual std::string getAdditionalInfo() const = 0;
+    virtual const std::string& getAdditionalInfo() const = 0;
     virtual std::string getType() const = 0;
 };
 
 class Student : public User {
-    std::string group;
+    StringInterner::Handle group;
 
 public:
     Student(const std::string& name, int id, const std::string& group)
-        : User(name, id, AccessLevel::STUDENT), group(group) {}
+        : User(name, id, AccessLevel::STUDENT), group(StringInterner::global().intern(group)) {}
 
     void displayInfo() const override {
         User::displayInfo();
-        std::cout << "Группа: " << group << "\n\n";
+        std::cout << "Группа: " << getAdditionalInfo() << "\n\n";
     }
 
-    std::string getAdditionalInfo() const override { return group; }
+    const std::string& getAdditionalInfo() const override { return StringInterner::global().get(group); }
     std::string getType() const override { return "Student"; }
 };
 
 class Teacher : public User {
-    std::string department;
+    StringInterner::Handle department;
 
 public:
     Teacher(const std::string& name, int id, const std::string& department)
-        : User(name, id, AccessLevel::TEACHER), department(department) {}
+        : User(name, id, AccessLevel::TEACHER), department(StringInterner::global().intern(department)) {}
 
     void displayInfo() const override {
         User::displayInfo();
-        std::cout << "Кафедра: " << department << "\n\n";
+        std::cout << "Кафедра: " << getAdditionalInfo() << "\n\n";
     }
 
-    std::string getAdditionalInfo() const override { return department; }
+    const std::string& getAdditionalInfo() const override { return StringInterner::global().get(department); }
     std::string getType() const override { return "Teacher"; }
 };
 
 class Administrator : public User {
-    std::string role;
+    StringInterner::Handle role;
+
+public:
+    Administrator(const std::string& name, int id, const std::string& role)
+        : User(name, id, AccessLevel::ADMIN), role(StringInterner::global().intern(role)) {}
+
+    void displayInfo() const override {
+        User::displayInfo();
+        std::cout << "Роль: " << getAdditionalInfo() << "\n\n";
+    }
+
+    const std::string& getAdditionalInfo() const override { return StringInterner::global().get(role); }
+    std::string getType() const override { return "Administrator"; }
+};
+
+class Resource {
+    StringInterner::Handle name;
+    AccessLevel requiredAccess;
+
+public:
+    Resource(const std::string& name, AccessLevel required)
+        : requiredAccess(required) {
+        if (name.empty()) throw std::invalid_argument("Имя ресурса не может быть пустым");
+        this->name = StringInterner::global().intern(name);
+    }
+
+    bool checkAccess(const User& user) const {
+        return static_cast<int>(user.getAccessLevel()) >= static_cast<int>(requiredAccess);
+    }
+
+    const std::string& getName() const { return StringInterner::global().get(name); }
+    StringInterner::Handle getNameHandle() const { return name; }
+
+    AccessLevel getRequiredAccess() const { return requiredAccess; }
+
+    void displayInfo() const {
+        std::cout << "Ресурс: " << getName()
+                  << "\nТребуемый уровень доступа: " << accessLevelName(requiredAccess) << "\n";
+    }
+};
+
+// Индекс ID пользователя -> позиция в векторе (открытая адресация, линейное пробирование).
+// Уровень доступа и группа пользователя не меняются, пока он на своей позиции, поэтому
+// хранятся в ячейке рядом с ID: проверка доступа читает одну ячейку вместо ячейки и столбцов
+class UserIdIndex {
+public:
+    struct Slot {
+        int id = 0; // 0 — пустая ячейка, ID всегда положительный
+        std::uint32_t pos = 0;
+        StringInterner::Handle info = 0;
+        AccessLevel level = AccessLevel::NONE;
+    };
+
+private:
+    std::vector<Slot> slots;
+    std::size_t count = 0;
+
+    std::size_t mask() const { return slots.size() - 1; }
+
+    static std::size_t hash(int id) {
+        std::uint64_t x = static_cast<std::uint32_t>(id) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(x >> 32);
+    }
+
+    void rehash(std::size_t capacity) {
+        std::vector<Slot> old = std::move(slots);
+        slots.assign(capacity, Slot{});
+        count = 0;
+        for (const auto& slot : old) {
+            if (slot.id != 0) place(slot);
+        }
+    }
+
+    void place(const Slot& slot) {
+        std::size_t i = hash(slot.id) & mask();
+        while (slots[i].id != 0 && slots[i].id != slot.id) i = (i + 1) & mask();
+        if (slots[i].id == 0) ++count;
+        slots[i] = slot;
+    }
+
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // nullptr — пользователя нет
+    const Slot* lookup(int id) const {
+        if (slots.empty() || id <= 0) return nullptr;
+        for (std::size_t i = hash(id) & mask();; i = (i + 1) & mask()) {
+            if (slots[i].id == id) return &slots[i];
+            if (slots[i].id == 0) return nullptr;
+        }
+    }
+
+    std::size_t find(int id) const {
+        const Slot* slot = lookup(id);
+        return slot ? slot->pos : npos;
+    }
+
+    void assign(int id, std::size_t pos, AccessLevel level, StringInterner::Handle info) {
+        // Коэффициент заполнения не выше 3/4
+        if ((count + 1) * 4 > slots.size() * 3) {
+            rehash(slots.empty() ? 16 : slots.size() * 2);
+        }
+        place(Slot{id, static_cast<std::uint32_t>(pos), info, level});
+    }
+
+    // Удаление со сдвигом назад, без надгробий
+    bool erase(int id) {
+        if (slots.empty() || id <= 0) return false;
+        std::size_t i = hash(id) & mask();
+        while (slots[i].id != id) {
+            if (slots[i].id == 0) return false;
+            i = (i + 1) & mask();
+        }
+        for (std::size_t j = (i + 1) & mask(); slots[j].id != 0; j = (j + 1) & mask()) {
+            std::size_t home = hash(slots[j].id) & mask();
+            // Элемент j можно перенести в i, если его домашняя ячейка не лежит в (i, j]
+            bool between = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+            if (!between) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i] = Slot{};
+        --count;
+        return true;
+    }
+
+    void reserve(std::size_t n) {
+        std::size_t capacity = 16;
+        while (capacity * 3 < n * 4) capacity *= 2;
+        if (capacity > slots.size()) rehash(capacity);
+    }
+
+    void clear() {
+        slots.clear();
+        count = 0;
+    }
+};
+
+// Имя ресурса -> позиция: открытая адресация, как в UserIdIndex. Ключи указывают на строки
+// в таблице интернирования; сохраненный хеш отсеивает чужие ячейки без чтения строки
+class ResourceNameIndex {
+    // Имя до inlineLength байт копируется в ячейку, и поиск не обращается к строке ресурса;
+    // у более длинного имени в ячейке указатель на внешнюю строку
+    static constexpr std::size_t inlineLength = 20;
+
+    struct Slot {
+        std::uint32_t hash = 0;
+        std::uint32_t pos = 0;
+        std::uint32_t length = 0; // 0 — свободная ячейка, имя ресурса не бывает пустым
+        char text[inlineLength] = {};
+
+        Slot() = default;
+
+        Slot(std::string_view name, std::uint32_t hash, std::uint32_t pos)
+            : hash(hash), pos(pos), length(static_cast<std::uint32_t>(name.size())) {
+            if (name.size() <= inlineLength) {
+                std::memcpy(text, name.data(), name.size());
+            } else {
+                const char* data = name.data();
+                std::memcpy(text, &data, sizeof(data));
+            }
+        }
+
+        bool used() const { return length != 0; }
+
+        std::string_view name() const {
+            if (length <= inlineLength) return {text, length};
+            const char* data;
+            std::memcpy(&data, text, sizeof(data));
+            return {data, length};
+        }
+    };
+
+    std::vector<Slot> slots;
+    std::size_t count = 0;
+
+    std::size_t mask() const { return slots.size() - 1; }
+
+    static std::uint32_t hash(std::string_view name) {
+        std::uint64_t x = std::hash<std::string_view>{}(name) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::uint32_t>(x >> 32);
+    }
+
+    std::size_t probe(std::string_view name, std::uint32_t h) const {
+        std::size_t i = h & mask();
+        while (slots[i].used() && (slots[i].hash != h || slots[i].name() != name)) i = (i + 1) & mask();
+        return i;
+    }
+
+    void rehash(std::size_t capacity) {
+        std::vector<Slot> old = std::move(slots);
+        slots.assign(capacity, Slot{});
+        for (const auto& slot : old) {
+            if (slot.used()) slots[probe(slot.name(), slot.hash)] = slot;
+        }
+    }
+
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::size_t find(std::string_view name) const {
+        if (slots.empty()) return npos;
+        const Slot& slot = slots[probe(name, hash(name))];
+        return slot.used() ? slot.pos : npos;
+    }
+
+    void assign(std::string_view name, std::size_t pos) {
+        // Коэффициент заполнения не выше 3/4
+        if ((count + 1) * 4 > slots.size() * 3) {
+            rehash(slots.empty() ? 16 : slots.size() * 2);
+        }
+        std::uint32_t h = hash(name);
+        Slot& slot = slots[probe(name, h)];
+        if (!slot.used()) ++count;
+        slot = Slot(name, h, static_cast<std::uint32_t>(pos));
+    }
+
+    // Удаление со сдвигом назад, без надгробий
+    bool erase(std::string_view name) {
+        if (slots.empty()) return false;
+        std::size_t i = probe(name, hash(name));
+        if (!slots[i].used()) return false;
+        for (std::size_t j = (i + 1) & mask(); slots[j].used(); j = (j + 1) & mask()) {
+            std::size_t home = slots[j].hash & mask();
+            bool between = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+            if (!between) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i] = Slot{};
+        --count;
+        return true;
+    }
+
+    void reserve(std::size_t n) {
+        std::size_t capacity = 16;
+        while (capacity * 3 < n * 4) capacity *= 2;
+        if (capacity > slots.size()) rehash(capacity);
+    }
+
+    void clear() {
+        slots.clear();
+        count = 0;
+    }
+};
+
+// Инвертированный индекс триграмм по полям пользователя (имя, ID, дополнительная информация).
+// Каждое поле предваряется меткой начала, поэтому префиксный запрос тоже сводится к триграммам
+class TrigramIndex {
+    static constexpr char fieldStart = '\x02';
+
+    std::unordered_map<std::uint32_t, std::vector<int>> postings; // отсортированные ID
+    std::size_t entryCount = 0;
+
+    // Удаленные ID остаются в списках как надгробия, пока снятых пар не
+    // наберется четверть индекса; тогда списки чистятся одним проходом
+    std::vector<std::pair<std::uint32_t, int>> pending;
+    std::unordered_set<int> erased;
+
+    static std::uint32_t pack(std::string_view text, std::size_t i) {
+        return static_cast<std::uint32_t>(static_cast<unsigned char>(text[i])) << 16 |
+               static_cast<std::uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8 |
+               static_cast<std::uint32_t>(static_cast<unsigned char>(text[i + 2]));
+    }
+
+    static void collect(std::string_view text, std::vector<std::uint32_t>& out) {
+        for (std::size_t i = 0; i + 3 <= text.size(); ++i) out.push_back(pack(text, i));
+    }
+
+    static std::vector<std::uint32_t> trigramsOf(std::initializer_list<std::string_view> fields) {
+        std::vector<std::uint32_t> result;
+        std::string padded;
+        for (std::string_view field : fields) {
+            padded.assign(1, fieldStart);
+            padded.append(field);
+            collect(padded, result);
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+public:
+    void insert(int id, std::initializer_list<std::string_view> fields) {
+        // Старые записи повторно занятого ID нужно убрать до вставки новых
+        if (erased.count(id)) compact();
+        for (std::uint32_t trigram : trigramsOf(fields)) {
+            auto& ids = postings[trigram];
+            // ID обычно растут, поэтому чаще всего это добавление в конец
+            ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+            ++entryCount;
+        }
+    }
+
+    // Набор удаляемых ID: пары (триграмма, ID) копятся, а затем каждый
+    // затронутый список очищается одним проходом. Для большого набора (sweep)
+    // триграммы не вычисляются: все списки просматриваются один раз целиком
+    class Removal {
+        friend class TrigramIndex;
+        std::vector<std::pair<std::uint32_t, int>> entries;
+        std::vector<int> ids;
+        bool sweep = false;
+
+    public:
+        Removal() = default;
+        explicit Removal(bool sweep) : sweep(sweep) {}
+
+        void add(int id, std::initializer_list<std::string_view> fields) {
+            if (sweep) {
+                ids.push_back(id);
+                return;
+            }
+            for (std::uint32_t trigram : trigramsOf(fields)) entries.emplace_back(trigram, id);
+        }
+    };
+
+    // Снятие ID из поиска; сами списки чистятся отложенно, а при полном
+    // проходе — сразу, вместе с накопленными ранее надгробиями
+    void erase(Removal& removal) {
+        if (removal.sweep) {
+            erased.insert(removal.ids.begin(), removal.ids.end());
+            removal.ids.clear();
+            sweep();
+            return;
+        }
+        for (const auto& entry : removal.entries) erased.insert(entry.second);
+        pending.insert(pending.end(), removal.entries.begin(), removal.entries.end());
+        removal.entries.clear();
+        if (pending.size() * 4 >= entryCount) compact();
+    }
+
+    // Все снятые ID выбрасываются из всех списков без сортировки пар
+    void sweep() {
+        for (auto it = postings.begin(); it != postings.end();) {
+            auto& ids = it->second;
+            const std::size_t before = ids.size();
+            std::erase_if(ids, [&](int id) { return erased.count(id) != 0; });
+            entryCount -= before - ids.size();
+            it = ids.empty() ? postings.erase(it) : std::next(it);
+        }
+        pending.clear();
+        erased.clear();
+    }
+
+    // Участки между удаляемыми ID каждого затронутого списка сдвигаются целиком
+    void compact() {
+        auto& entries = pending;
+        std::sort(entries.begin(), entries.end());
+        for (auto group = entries.begin(); group != entries.end();) {
+            auto groupEnd = std::find_if(group, entries.end(),
+                [&](const auto& entry) { return entry.first != group->first; });
+            auto it = postings.find(group->first);
+            if (it != postings.end()) {
+                auto& ids = it->second;
+                auto out = ids.begin();
+                auto read = ids.begin();
+                for (auto victim = group; victim != groupEnd; ++victim) {
+                    auto pos = std::lower_bound(read, ids.end(), victim->second);
+                    out = out == read ? pos : std::move(read, pos, out);
+                    read = pos;
+                    if (read != ids.end() && *read == victim->second) ++read;
+                }
+                if (out != read) out = std::move(read, ids.end(), out);
+                else out = ids.end();
+                entryCount -= static_cast<std::size_t>(ids.end() - out);
+                ids.erase(out, ids.end());
+                if (ids.empty()) postings.erase(it);
+            }
+            group = groupEnd;
+        }
+        entries.clear();
+        erased.clear();
+    }
+
+    // ID, поля которых содержат все триграммы запроса; совпадение нужно проверить.
+    // false — запрос короче триграммы и индекс не сужает поиск
+    bool candidates(std::string_view query, bool prefix, std::vector<int>& out) const {
+        std::string text = prefix ? fieldStart + std::string(query) : std::string(query);
+        if (text.size() < 3) return false;
+
+        std::vector<std::uint32_t> trigrams;
+        collect(text, trigrams);
+        std::vector<const std::vector<int>*> lists;
+        for (std::uint32_t trigram : trigrams) {
+            auto it = postings.find(trigram);
+            if (it == postings.end()) {
+                out.clear();
+                return true;
+            }
+            lists.push_back(&it->second);
+        }
+        std::sort(lists.begin(), lists.end(),
+            [](const auto* a, const auto* b) { return a->size() < b->size(); });
+
+        out = *lists.front();
+        std::vector<int> next;
+        for (std::size_t i = 1; i < lists.size() && !out.empty(); ++i) {
+            next.clear();
+            std::set_intersection(out.begin(), out.end(), lists[i]->begin(), lists[i]->end(),
+                                  std::back_inserter(next));
+            out.swap(next);
+        }
+        if (!erased.empty()) {
+            std::erase_if(out, [&](int id) { return erased.count(id) != 0; });
+        }
+        return true;
+    }
+
+    void clear() {
+        postings.clear();
+        entryCount = 0;
+        pending.clear();
+        erased.clear();
+    }
+};
+
+// Ссылка на строку в арене
+struct StringRef {
+    std::uint32_t offset = 0;
+    std::uint32_t length = 0;
+};
+
+// Строковая арена: строки лежат подряд в одном буфере
+class StringArena {
+    std::string bytes;
+    std::size_t released = 0;
+
+public:
+    StringRef add(std::string_view value) {
+        if (bytes.size() + value.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("Переполнение строковой арены");
+        }
+        StringRef ref{static_cast<std::uint32_t>(bytes.size()), static_cast<std::uint32_t>(value.size())};
+        bytes.append(value);
+        return ref;
+    }
+
+    std::string_view get(StringRef ref) const {
+        return std::string_view(bytes).substr(ref.offset, ref.length);
+    }
+
+    // Освобожденные байты возвращаются только при пересборке арены
+    void release(StringRef ref) { released += ref.length; }
+    bool fragmented() const { return released > 4096 && released * 2 > bytes.size(); }
+
+    void reserve(std::size_t size) { bytes.reserve(size); }
+    std::size_t size() const { return bytes.size(); }
+    std::size_t capacity() const { return bytes.capacity(); }
+
+    void clear() {
+        bytes.clear();
+        released = 0;
+    }
+};
+
+// Дескриптор слота: позиция и поколение. Дескриптор удаленного элемента
+// становится недействительным, даже если слот занят снова
+struct SlotHandle {
+    std::uint32_t slot = 0;
+    std::uint32_t generation = 0;
+};
+
+// Распределитель слотов с поколениями: удаление за O(1), освободившиеся слоты
+// переиспользуются. Нечетное поколение — слот занят
+class SlotAllocator {
+    std::vector<std::uint32_t> generations;
+    std::vector<std::uint32_t> freeSlots;
+    std::size_t live = 0;
+
+public:
+    static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+    // Новый слот равен capacity() - 1, если свободных не было
+    std::uint32_t acquire() {
+        ++live;
+        if (!freeSlots.empty()) {
+            std::uint32_t slot = freeSlots.back();
+            freeSlots.pop_back();
+            ++generations[slot];
+            return slot;
+        }
+        if (generations.size() >= npos) {
+            throw std::runtime_error("Исчерпаны слоты хранилища");
+        }
+        generations.push_back(1);
+        return static_cast<std::uint32_t>(generations.size() - 1);
+    }
+
+    void release(std::uint32_t slot) {
+        ++generations[slot];
+        freeSlots.push_back(slot);
+        --live;
+    }
+
+    bool alive(std::size_t slot) const { return generations[slot] & 1; }
+    SlotHandle handle(std::uint32_t slot) const { return {slot, generations[slot]}; }
+
+    bool valid(SlotHandle h) const {
+        return h.slot < generations.size() && generations[h.slot] == h.generation && alive(h.slot);
+    }
+
+    std::size_t size() const { return live; }
+    std::size_t capacity() const { return generations.size(); }
+    std::size_t holes() const { return freeSlots.size(); }
+
+    void reserve(std::size_t count) { generations.reserve(count); }
+
+    void clear() {
+        generations.clear();
+        freeSlots.clear();
+        live = 0;
+    }
+
+    // Плотная упаковка занятых слотов с сохранением порядка. Возвращает новые
+    // позиции (npos для пустых слотов); все выданные ранее дескрипторы устаревают
+    std::vector<std::uint32_t> compact() {
+        std::vector<std::uint32_t> remap(generations.size(), npos);
+        std::uint32_t newest = 0;
+        std::uint32_t next = 0;
+        for (std::size_t slot = 0; slot < generations.size(); ++slot) {
+            newest = std::max(newest, generations[slot]);
+            if (alive(slot)) remap[slot] = next++;
+        }
+        generations.assign(next, (newest | 1) + 2);
+        freeSlots.clear();
+        return remap;
+    }
+
+    std::size_t memoryUsage() const {
+        return (generations.capacity() + freeSlots.capacity()) * sizeof(std::uint32_t);
+    }
+};
+
+// Хранилище с устойчивыми позициями: элементы не сдвигаются при удалении
+template<typename T>
+class SlotMap {
+    std::vector<std::optional<T>> items;
+    SlotAllocator slots;
+
+public:
+    std::uint32_t insert(T&& value) {
+        std::uint32_t slot = slots.acquire();
+        if (slot == items.size()) {
+            items.emplace_back(std::move(value));
+        } else {
+            items[slot].emplace(std::move(value));
+        }
+        return slot;
+    }
+
+    void erase(std::uint32_t slot) {
+        items[slot].reset();
+        slots.release(slot);
+    }
+
+    const T& operator[](std::size_t slot) const { return *items[slot]; }
+    bool alive(std::size_t slot) const { return slots.alive(slot); }
+
+    std::size_t size() const { return slots.size(); }
+    bool empty() const { return slots.size() == 0; }
+    std::size_t capacity() const { return slots.capacity(); }
+
+    void reserve(std::size_t count) {
+        items.reserve(count);
+        slots.reserve(count);
+    }
+
+    void clear() {
+        items.clear();
+        slots.clear();
+    }
+
+    // Обход занятых слотов по возрастанию позиции: f(slot, item)
+    template<typename F>
+    void forEach(F f) const {
+        for (std::size_t slot = 0; slot < items.size(); ++slot) {
+            if (items[slot]) f(slot, *items[slot]);
+        }
+    }
+};
+
+// Колоночное хранилище пользователей: ID, уровни доступа, типы и дескрипторы
+// дополнительной информации лежат в плотных массивах, имена — в строковой арене.
+// Позиция пользователя — слот: удаление оставляет пустой слот, новый пользователь
+// занимает его снова. Столбцы пустого слота сохраняют прежние значения
+class UserStore {
+    std::vector<int> ids;
+    std::vector<AccessLevel> levels;
+    std::vector<UserType> types;
+    std::vector<StringRef> names;
+    std::vector<StringInterner::Handle> infos;
+    StringArena arena;
+    SlotAllocator slots;
+
+    void compactArena() {
+        StringArena packed;
+        packed.reserve(arena.size());
+        for (std::size_t pos = 0; pos < capacity(); ++pos) {
+            if (alive(pos)) names[pos] = packed.add(arena.get(names[pos]));
+        }
+        arena = std::move(packed);
+    }
+
+    template<typename Column>
+    static void compactColumn(Column& column, const std::vector<std::uint32_t>& remap) {
+        for (std::size_t pos = 0; pos < remap.size(); ++pos) {
+            if (remap[pos] != SlotAllocator::npos) column[remap[pos]] = column[pos];
+        }
+        column.resize(std::count_if(remap.begin(), remap.end(),
+            [](std::uint32_t slot) { return slot != SlotAllocator::npos; }));
+    }
+
+public:
+    // Число пользователей и число слотов, включая пустые
+    std::size_t size() const { return slots.size(); }
+    std::size_t capacity() const { return slots.capacity(); }
+    bool empty() const { return slots.size() == 0; }
+    bool alive(std::size_t pos) const { return slots.alive(pos); }
+    std::size_t holes() const { return slots.holes(); }
+
+    SlotHandle handle(std::size_t pos) const { return slots.handle(static_cast<std::uint32_t>(pos)); }
+    bool valid(SlotHandle h) const { return slots.valid(h); }
+
+    void reserve(std::size_t count) {
+        ids.reserve(count);
+        levels.reserve(count);
+        types.reserve(count);
+        names.reserve(count);
+        infos.reserve(count);
+        slots.reserve(count);
+    }
+
+    // Возвращает слот нового пользователя
+    std::size_t insert(UserType type, int id, std::string_view name, std::string_view info) {
+        StringRef nameRef = arena.add(name);
+        StringInterner::Handle infoHandle = StringInterner::global().intern(info);
+        std::uint32_t pos = slots.acquire();
+        if (pos == ids.size()) {
+            ids.push_back(id);
+            levels.push_back(accessLevelOf(type));
+            types.push_back(type);
+            names.push_back(nameRef);
+            infos.push_back(infoHandle);
+        } else {
+            ids[pos] = id;
+            levels[pos] = accessLevelOf(type);
+            types[pos] = type;
+            names[pos] = nameRef;
+            infos[pos] = infoHandle;
+        }
+        return pos;
+    }
+
+    // O(1): остальные пользователи остаются на своих местах
+    void erase(std::size_t pos) {
+        arena.release(names[pos]);
+        slots.release(static_cast<std::uint32_t>(pos));
+        if (arena.fragmented()) compactArena();
+    }
+
+    // Сдвигает пользователей к началу с сохранением порядка; возвращает
+    // новые позиции по старым (SlotAllocator::npos для пустых слотов)
+    std::vector<std::uint32_t> compact() {
+        compactArena();
+        std::vector<std::uint32_t> remap = slots.compact();
+        compactColumn(ids, remap);
+        compactColumn(levels, remap);
+        compactColumn(types, remap);
+        compactColumn(names, remap);
+        compactColumn(infos, remap);
+        return remap;
+    }
+
+    void clear() {
+        ids.clear();
+        levels.clear();
+        types.clear();
+        names.clear();
+        infos.clear();
+        arena.clear();
+        slots.clear();
+    }
+
+    int id(std::size_t pos) const { return ids[pos]; }
+    AccessLevel level(std::size_t pos) const { return levels[pos]; }
+    UserType type(std::size_t pos) const { return types[pos]; }
+    std::string_view name(std::size_t pos) const { return arena.get(names[pos]); }
+    std::string_view info(std::size_t pos) const { return StringInterner::global().get(infos[pos]); }
+    StringInterner::Handle infoHandle(std::size_t pos) const { return infos[pos]; }
+
+    std::span<const int> idColumn() const { return ids; }
+    std::span<const AccessLevel> levelColumn() const { return levels; }
+
+    // Занимаемая память в байтах без учета общей таблицы интернирования
+    std::size_t memoryUsage() const {
+        return sizeof(*this) + ids.capacity() * sizeof(int) + levels.capacity() * sizeof(AccessLevel) +
+               types.capacity() * sizeof(UserType) + names.capacity() * sizeof(StringRef) +
+               infos.capacity() * sizeof(StringInterner::Handle) + arena.capacity() + slots.memoryUsage();
+    }
+};
+
+// Легкое представление пользователя из UserStore с интерфейсом User
+class UserView {
+    const UserStore* store;
+    std::size_t pos;
+
+public:
+    UserView(const UserStore& store, std::size_t pos) : store(&store), pos(pos) {}
+
+    std::string_view getName() const { return store->name(pos); }
+    int getId() const { return store->id(pos); }
+    AccessLevel getAccessLevel() const { return store->level(pos); }
+    std::string_view getAdditionalInfo() const { return store->info(pos); }
+    std::string_view getType() const { return userTypeName(store->type(pos)); }
+
+    void displayInfo() const {
+        std::cout << "Имя: " << getName() << "\nID: " << getId()
+                  << "\nУровень доступа: " << accessLevelName(getAccessLevel()) << "\n";
+        switch(store->type(pos)) {
+            case UserType::STUDENT: std::cout << "Группа: "; break;
+            case UserType::TEACHER: std::cout << "Кафедра: "; break;
+            case UserType::ADMINISTRATOR: std::cout << "Роль: "; break;
+        }
+        std::cout << getAdditionalInfo() << "\n\n";
+    }
+};
+
+// Матрица решений: для каждого уровня доступа — битовое множество доступных ресурсов
+class AccessMatrix {
+    static constexpr std::size_t levelCount = static_cast<std::size_t>(AccessLevel::ADMIN) + 1;
+
+    std::array<std::vector<std::uint64_t>, levelCount> bits;
+    std::size_t size = 0;
+
+public:
+    // Пересчитывает бит ресурса в позиции pos для всех уровней
+    void assign(std::size_t pos, AccessLevel required) {
+        if (pos >= size) {
+            size = pos + 1;
+            for (auto& row : bits) row.resize((size + 63) / 64, 0);
+        }
+        std::uint64_t mask = std::uint64_t{1} << (pos % 64);
+        for (std::size_t level = 0; level < levelCount; ++level) {
+            if (level >= static_cast<std::size_t>(required)) {
+                bits[level][pos / 64] |= mask;
+            } else {
+                bits[level][pos / 64] &= ~mask;
+            }
+        }
+    }
+
+    // Ресурс удален: слот запрещен для всех уровней
+    void reset(std::size_t pos) {
+        if (pos >= size) return;
+        for (auto& row : bits) row[pos / 64] &= ~(std::uint64_t{1} << (pos % 64));
+    }
+
+    bool allows(AccessLevel level, std::size_t pos) const {
+        return (bits[static_cast<std::size_t>(level)][pos / 64] >> (pos % 64)) & 1;
+    }
+
+    void clear() {
+        for (auto& row : bits) row.clear();
+        size = 0;
+    }
+};
+
+// Политика, скомпилированная в плоскую программу решения:
+// [число запретов, ID...] [число разрешений, ID...] [число групп, дескрипторы...] [уровень + 1 или 0].
+// Списки отсортированы, группы сравниваются по интернированным дескрипторам,
+// поэтому на горячем пути нет строк и разбора правил
+class CompiledPolicy {
+    AccessPolicy source;
+    std::vector<std::uint32_t> program;
+
+    void emit(std::vector<std::uint32_t> section) {
+        std::sort(section.begin(), section.end());
+        program.push_back(static_cast<std::uint32_t>(section.size()));
+        program.insert(program.end(), section.begin(), section.end());
+    }
+
+public:
+    CompiledPolicy(AccessPolicy policy, AccessLevel required) : source(std::move(policy)) {
+        emit({source.deniedUsers.begin(), source.deniedUsers.end()});
+        emit({source.allowedUsers.begin(), source.allowedUsers.end()});
+        std::vector<std::uint32_t> groups;
+        for (const std::string& group : source.groups) {
+            groups.push_back(StringInterner::global().intern(group));
+        }
+        emit(std::move(groups));
+        program.push_back(source.levelGrant ? static_cast<std::uint32_t>(required) + 1 : 0);
+    }
+
+    const AccessPolicy& policy() const { return source; }
+
+    // Решение без учета времени
+    bool decide(int id, StringInterner::Handle info, AccessLevel level) const {
+        return run(id, level, [info](const std::uint32_t* groups, std::uint32_t count) {
+            return contains(groups, count, info);
+        });
+    }
+
+    // То же по строке группы — для строк вне таблицы (отображенный снимок): поиск их
+    // дескриптора под блокировкой таблицы дороже сравнения с группами политики
+    bool decide(int id, std::string_view info, AccessLevel level) const {
+        return run(id, level, [&](const std::uint32_t*, std::uint32_t) {
+            return std::find(source.groups.begin(), source.groups.end(), info) != source.groups.end();
+        });
+    }
+
+    // Время запрашивается, только если у политики есть окна
+    bool open() const { return source.windows.empty() || source.open(std::chrono::system_clock::now()); }
+    bool open(std::chrono::system_clock::time_point when) const { return source.open(when); }
+
+private:
+    static bool contains(const std::uint32_t* list, std::uint32_t count, std::uint32_t key) {
+        // Короткий список быстрее просмотреть подряд: std::find развернут и выходит
+        // по предсказуемой ветви, а просмотр без ветвлений ждет сравнения всех элементов
+        if (count <= 32) return std::find(list, list + count, key) != list + count;
+        return std::binary_search(list, list + count, key);
+    }
+
+    template<typename GroupMatch>
+    bool run(int id, AccessLevel level, GroupMatch groupMatch) const {
+        const std::uint32_t* pc = program.data();
+        auto section = [&pc](auto match) {
+            std::uint32_t count = *pc++;
+            bool found = match(pc, count);
+            pc += count;
+            return found;
+        };
+        auto listed = [key = static_cast<std::uint32_t>(id)](const std::uint32_t* list, std::uint32_t count) {
+            return contains(list, count, key);
+        };
+        if (section(listed)) return false;
+        if (section(listed)) return true;
+        if (section(groupMatch)) return true;
+        return *pc != 0 && static_cast<std::uint32_t>(level) + 1 >= *pc;
+    }
+};
+
+// Собственные политики ресурсов: бит в custom отмечает слоты ресурсов, которые
+// проверяются скомпилированной политикой, а не матрицей уровней
+class PolicyTable {
+    std::vector<std::uint64_t> custom;
+    std::unordered_map<std::size_t, CompiledPolicy> compiled;
+
+public:
+    bool isCustom(std::size_t resPos) const {
+        return resPos / 64 < custom.size() && (custom[resPos / 64] >> (resPos % 64)) & 1;
+    }
+
+    const CompiledPolicy& at(std::size_t resPos) const { return compiled.at(resPos); }
+
+    void assign(std::size_t resPos, CompiledPolicy policy) {
+        if (resPos / 64 >= custom.size()) custom.resize(resPos / 64 + 1, 0);
+        custom[resPos / 64] |= std::uint64_t{1} << (resPos % 64);
+        compiled.insert_or_assign(resPos, std::move(policy));
+    }
+
+    void reset(std::size_t resPos) {
+        if (!isCustom(resPos)) return;
+        custom[resPos / 64] &= ~(std::uint64_t{1} << (resPos % 64));
+        compiled.erase(resPos);
+    }
+
+    void clear() {
+        custom.clear();
+        compiled.clear();
+    }
+};
+
+// Неизменяемый снимок для параллельных читателей: индексы для проверок доступа
+// и копии пользователей и ресурсов для вывода на экран
+struct AccessSnapshot {
+    std::uint64_t version = 0;
+    UserStore users;
+    SlotMap<Resource> resources;
+    UserIdIndex userIndex;
+    ResourceNameIndex resourceIndex;
+    AccessMatrix accessMatrix;
+    PolicyTable policies;
+
+    // Время запрашивается, только если у политики ресурса есть окна
+    bool checkAccess(int userId, std::string_view resourceName) const {
+        return check(userId, resourceName, [](const CompiledPolicy& policy) { return policy.open(); });
+    }
+
+    bool checkAccess(int userId, std::string_view resourceName, std::chrono::system_clock::time_point when) const {
+        return check(userId, resourceName, [when](const CompiledPolicy& policy) { return policy.open(when); });
+    }
+
+private:
+    template<typename Open>
+    bool check(int userId, std::string_view resourceName, Open open) const {
+        const UserIdIndex::Slot* user = userIndex.lookup(userId);
+        if (!user) return false;
+        std::size_t resPos = resourceIndex.find(resourceName);
+        if (resPos == ResourceNameIndex::npos) return false;
+        if (policies.isCustom(resPos)) {
+            const CompiledPolicy& policy = policies.at(resPos);
+            return policy.decide(userId, user->info, user->level) && open(policy);
+        }
+        return accessMatrix.allows(user->level, resPos);
+    }
+};
+
+// Фиксированный пул потоков; вызывающий поток тоже участвует в работе
+class WorkerPool {
+    std::vector<std::thread> threads;
+    std::mutex callMutex;
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::function<void(std::size_t)> job;
+    std::size_t jobCount = 0;
+    std::atomic<std::size_t> nextJob{0};
+    std::size_t finished = 0;
+    std::uint64_t generation = 0;
+    bool stopping = false;
+
+    void drain() {
+        for (std::size_t i; (i = nextJob.fetch_add(1)) < jobCount;) job(i);
+    }
+
+    void workerLoop() {
+        std::uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            lock.unlock();
+            drain();
+            lock.lock();
+            if (++finished == threads.size()) done.notify_one();
+        }
+    }
+
+public:
+    explicit WorkerPool(std::size_t threadCount) {
+        // Вызывающий поток — один из исполнителей
+        for (std::size_t i = 1; i < threadCount; ++i) {
+            threads.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) thread.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    std::size_t size() const { return threads.size() + 1; }
+
+    // Выполняет fn(0) ... fn(count - 1) и ждет завершения всех задач
+    void parallelFor(std::size_t count, std::function<void(std::size_t)> fn) {
+        std::lock_guard<std::mutex> call(callMutex);
+        std::unique_lock<std::mutex> lock(mtx);
+        job = std::move(fn);
+        jobCount = count;
+        nextJob = 0;
+        finished = 0;
+        ++generation;
+        lock.unlock();
+        wake.notify_all();
+
+        drain();
+
+        lock.lock();
+        done.wait(lock, [&] { return finished == threads.size(); });
+        job = nullptr;
+    }
+};
+
+// Бинарный снимок системы. Раскладка файла (все смещения от начала, выровнены на 8):
+// заголовок | пользователи | ресурсы | индекс пользователей по ID | индекс ресурсов по имени | пул строк
+constexpr char snapshotMagic[4] = {'A', 'C', 'S', 'B'};
+constexpr std::uint32_t snapshotVersion = 4;
+
+struct SnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t userCount;
+    std::uint32_t resourceCount;
+    std::uint64_t fileSize;
+    std::uint64_t usersOffset;
+    std::uint64_t resourcesOffset;
+    std::uint64_t userByIdOffset;       // SnapshotKey[userCount] по возрастанию ID
+    std::uint64_t resourceByNameOffset; // SnapshotKey[resourceCount] по возрастанию хеша имени
+    std::uint64_t stringsOffset;
+    std::uint64_t stringsSize;
+    std::uint64_t policiesOffset;       // закодированные политики ресурсов подряд
+    std::uint64_t policiesSize;
+    std::uint64_t journalSequence;      // последняя запись журнала, вошедшая в снимок
+};
+
+struct SnapshotUser {
+    std::int32_t id;
+    UserType type;
+    AccessLevel accessLevel;
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+    std::uint32_t infoOffset;
+    std::uint32_t infoLength;
+};
+
+struct SnapshotResource {
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+    AccessLevel requiredAccess;
+    std::uint32_t policyOffset;
+    std::uint32_t policyLength;         // 0 — политика по умолчанию
+};
+
+// Элемент индекса: ключ хранится рядом с позицией записи, поэтому двоичный поиск
+// идет по плотному массиву и читает саму запись один раз, а имена сравнивает только
+// при совпадении хешей
+struct SnapshotKey {
+    std::uint32_t key;                  // ID пользователя или хеш имени ресурса
+    std::uint32_t pos;
+};
+
+// Хеш имени записывается в файл, поэтому не зависит от стандартной библиотеки (FNV-1a)
+constexpr std::uint32_t snapshotNameHash(std::string_view name) {
+    std::uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Отображенный в память снимок; объекты User и Resource не создаются.
+// При открытии проверяются только заголовок и границы разделов, поэтому оно не
+// зависит от размера снимка. Записи, позиции из индексов и строки проверяются
+// при обращении к ним, политики компилируются при первой проверке доступа к ресурсу
+class MappedSnapshot {
+    const char* data = nullptr;
+    std::size_t size = 0;
+    // Скомпилированные собственные политики по позиции ресурса: таблица создается
+    // при первой проверке, готовая политика читается без блокировок
+    mutable std::once_flag policiesCreated;
+    mutable std::unique_ptr<std::atomic<const CompiledPolicy*>[]> compiledPolicies;
+
+    const SnapshotHeader& header() const {
+        return *reinterpret_cast<const SnapshotHeader*>(data);
+    }
+
+    template<typename T>
+    std::span<const T> table(std::uint64_t offset, std::uint32_t count) const {
+        return {reinterpret_cast<const T*>(data + offset), count};
+    }
+
+    void checkRange(std::uint64_t offset, std::uint64_t length) const {
+        if (offset % 8 != 0 || offset > size || length > size - offset) {
+            throw std::runtime_error("Поврежденный снимок");
+        }
+    }
+
+    void validate() const {
+        const SnapshotHeader& h = header();
+        if (std::memcmp(h.magic, snapshotMagic, sizeof(snapshotMagic)) != 0) {
+            throw std::runtime_error("Файл не является снимком системы доступа");
+        }
+        if (h.version != snapshotVersion) {
+            throw std::runtime_error("Неподдерживаемая версия снимка");
+        }
+        if (h.fileSize != size) {
+            throw std::runtime_error("Поврежденный снимок");
+        }
+        checkRange(h.usersOffset, std::uint64_t{h.userCount} * sizeof(SnapshotUser));
+        checkRange(h.resourcesOffset, std::uint64_t{h.resourceCount} * sizeof(SnapshotResource));
+        checkRange(h.userByIdOffset, std::uint64_t{h.userCount} * sizeof(SnapshotKey));
+        checkRange(h.resourceByNameOffset, std::uint64_t{h.resourceCount} * sizeof(SnapshotKey));
+        checkRange(h.stringsOffset, h.stringsSize);
+        checkRange(h.policiesOffset, h.policiesSize);
+    }
+
+    static void corrupt() {
+        throw std::runtime_error("Поврежденный снимок");
+    }
+
+    static bool validLevel(AccessLevel level) {
+        return static_cast<unsigned>(level) <= static_cast<unsigned>(AccessLevel::ADMIN);
+    }
+
+    // Позиция из индекса: используется, только если попадает в таблицу
+    template<typename T>
+    static const T& at(std::span<const T> all, std::uint32_t pos) {
+        if (pos >= all.size()) corrupt();
+        return all[pos];
+    }
+
+public:
+    explicit MappedSnapshot(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Не удалось открыть файл для чтения");
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Поврежденный снимок");
+        }
+        size = static_cast<std::size_t>(info.st_size);
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            throw std::runtime_error("Не удалось отобразить снимок в память");
+        }
+        data = static_cast<const char*>(addr);
+        try {
+            validate();
+        } catch (...) {
+            ::munmap(addr, size);
+            throw;
+        }
+    }
+
+    ~MappedSnapshot() {
+        if (compiledPolicies) {
+            for (std::uint32_t pos = 0; pos < header().resourceCount; ++pos) delete compiledPolicies[pos].load();
+        }
+        ::munmap(const_cast<char*>(data), size);
+    }
+
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+    std::uint64_t journalSequence() const {
+        return header().journalSequence;
+    }
+
+    std::span<const SnapshotUser> users() const {
+        return table<SnapshotUser>(header().usersOffset, header().userCount);
+    }
+
+    std::span<const SnapshotResource> resources() const {
+        return table<SnapshotResource>(header().resourcesOffset, header().resourceCount);
+    }
+
+    // Перечисления записи сравниваются как уровни доступа, поэтому проверяются
+    // перед использованием: при поиске и при переносе снимка в систему
+    const SnapshotUser& check(const SnapshotUser& user) const {
+        if (static_cast<unsigned>(user.type) < static_cast<unsigned>(UserType::STUDENT) ||
+            static_cast<unsigned>(user.type) > static_cast<unsigned>(UserType::ADMINISTRATOR) ||
+            !validLevel(user.accessLevel)) {
+            corrupt();
+        }
+        return user;
+    }
+
+    const SnapshotResource& check(const SnapshotResource& resource) const {
+        if (!validLevel(resource.requiredAccess)) corrupt();
+        return resource;
+    }
+
+    // Строки проверяются при обращении, а не при открытии
+    std::string_view string(std::uint32_t offset, std::uint32_t length) const {
+        if (offset > header().stringsSize || length > header().stringsSize - offset) {
+            throw std::runtime_error("Поврежденный снимок");
+        }
+        return {data + header().stringsOffset + offset, length};
+    }
+
+    // Закодированная политика ресурса; пусто — политика по умолчанию
+    std::string_view policy(const SnapshotResource& resource) const {
+        if (resource.policyOffset > header().policiesSize ||
+            resource.policyLength > header().policiesSize - resource.policyOffset) {
+            throw std::runtime_error("Поврежденный снимок");
+        }
+        return {data + header().policiesOffset + resource.policyOffset, resource.policyLength};
+    }
+
+    const SnapshotUser* findUser(int id) const {
+        if (id <= 0) return nullptr;
+        auto index = table<SnapshotKey>(header().userByIdOffset, header().userCount);
+        std::uint32_t key = static_cast<std::uint32_t>(id);
+        auto it = std::lower_bound(index.begin(), index.end(), key,
+            [](const SnapshotKey& entry, std::uint32_t value) { return entry.key < value; });
+        if (it == index.end() || it->key != key) return nullptr;
+        const SnapshotUser& user = at(users(), it->pos);
+        if (user.id != id) corrupt();
+        return &check(user);
+    }
+
+    const SnapshotResource* findResource(std::string_view name) const {
+        auto index = table<SnapshotKey>(header().resourceByNameOffset, header().resourceCount);
+        auto all = resources();
+        std::uint32_t hash = snapshotNameHash(name);
+        auto it = std::lower_bound(index.begin(), index.end(), hash,
+            [](const SnapshotKey& entry, std::uint32_t value) { return entry.key < value; });
+        for (; it != index.end() && it->key == hash; ++it) {
+            const SnapshotResource& resource = at(all, it->pos);
+            if (string(resource.nameOffset, resource.nameLength) == name) return &check(resource);
+        }
+        return nullptr;
+    }
+
+    // Политика ресурса и проверка доступа прямо по отображенному файлу;
+    // определены после кодека политик
+    const CompiledPolicy* compiledPolicy(const SnapshotResource& resource) const;
+    bool checkAccess(int userId, std::string_view resourceName) const;
+};
+
+// Запись содержимого файла целиком через временный файл и rename
+void writeFileAtomically(const std::string& filename, const std::string& data) {
+    std::string tmpName = filename + ".tmp";
+    int fd = ::open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Не удалось открыть файл для записи");
+    }
+    for (std::size_t written = 0; written < data.size();) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0) {
+            ::close(fd);
+            throw std::runtime_error("Ошибка записи в файл");
+        }
+        written += static_cast<std::size_t>(n);
+    }
+    if (::fsync(fd) != 0 || ::close(fd) != 0 || std::rename(tmpName.c_str(), filename.c_str()) != 0) {
+        throw std::runtime_error("Ошибка записи в файл");
+    }
+}
+
+// Политика сброса журнала на диск
+enum class FsyncPolicy {
+    NEVER,    // только write, сброс на диск решает ОС
+    ALWAYS,   // fsync при каждой фиксации группы
+    INTERVAL  // fsync не чаще одного раза за syncInterval
+};
+
+struct JournalOptions {
+    FsyncPolicy fsyncPolicy = FsyncPolicy::ALWAYS;
+    std::chrono::milliseconds syncInterval{100};
+    std::size_t groupCommitBytes = 64 * 1024; // при переполнении группа фиксируется сама
+};
+
+enum class JournalOp : std::uint8_t {
+    ADD_USER = 1,
+    DELETE_USER,
+    ADD_RESOURCE,
+    DELETE_RESOURCE,
+    SET_POLICY
+};
+
+struct JournalEntry {
+    std::uint64_t sequence;
+    JournalOp op;
+    std::string_view payload;
+};
+
+// Последовательное чтение полей записи журнала
+class JournalReader {
+    std::string_view data;
+    std::size_t pos = 0;
+
+    void need(std::size_t length) const {
+        if (length > data.size() - pos) throw std::runtime_error("Поврежденная запись журнала");
+    }
+
+public:
+    explicit JournalReader(std::string_view data) : data(data) {}
+
+    std::uint8_t u8() {
+        need(1);
+        return static_cast<std::uint8_t>(data[pos++]);
+    }
+
+    std::uint32_t u32() {
+        need(4);
+        std::uint32_t value;
+        std::memcpy(&value, data.data() + pos, 4);
+        pos += 4;
+        return value;
+    }
+
+    std::uint64_t u64() {
+        need(8);
+        std::uint64_t value;
+        std::memcpy(&value, data.data() + pos, 8);
+        pos += 8;
+        return value;
+    }
+
+    std::string_view str() {
+        std::uint32_t length = u32();
+        need(length);
+        std::string_view value = data.substr(pos, length);
+        pos += length;
+        return value;
+    }
+};
+
+// Только дописываемый журнал изменений с групповой фиксацией.
+// Запись: длина данных (u32), контрольная сумма (u32), номер (u64), операция (u8), данные
+class Journal {
+    static constexpr std::size_t recordHeaderSize = 17;
+
+    std::string path;
+    JournalOptions options;
+    int fd = -1;
+    std::string pending;
+    std::uint64_t lastSequence;
+    std::uint64_t committedBytes = 0;
+    std::uint64_t syncedBytes = 0;
+    std::chrono::steady_clock::time_point lastSync = std::chrono::steady_clock::now();
+
+    // При INTERVAL фоновый поток досбрасывает группу, после которой фиксаций больше не было.
+    // fileMutex защищает дескриптор и счетчики от этого потока
+    std::mutex fileMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread flusher;
+
+    static std::uint32_t checksum(std::uint64_t sequence, JournalOp op, std::string_view payload) {
+        std::uint32_t hash = 2166136261u; // FNV-1a
+        auto mix = [&hash](const void* bytes, std::size_t length) {
+            for (std::size_t i = 0; i < length; ++i) {
+                hash = (hash ^ static_cast<const unsigned char*>(bytes)[i]) * 16777619u;
+            }
+        };
+        mix(&sequence, sizeof(sequence));
+        mix(&op, sizeof(op));
+        mix(payload.data(), payload.size());
+        return hash;
+    }
+
+    static void put(std::string& out, const void* bytes, std::size_t length) {
+        out.append(static_cast<const char*>(bytes), length);
+    }
+
+    void open(std::uint64_t validLength) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Не удалось открыть журнал");
+        }
+        // Недописанный после сбоя хвост отбрасывается
+        if (::ftruncate(fd, static_cast<off_t>(validLength)) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Не удалось открыть журнал");
+        }
+        committedBytes = validLength;
+        syncedBytes = validLength;
+    }
+
+    void sync(std::chrono::steady_clock::time_point now) {
+        if (::fdatasync(fd) != 0) throw std::runtime_error("Ошибка записи в журнал");
+        syncedBytes = committedBytes;
+        lastSync = now;
+    }
+
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(fileMutex);
+        while (!stopping) {
+            wake.wait_for(lock, options.syncInterval);
+            auto now = std::chrono::steady_clock::now();
+            // Ошибку сброса здесь некому вернуть; она повторится при следующей фиксации
+            if (syncedBytes != committedBytes && now - lastSync >= options.syncInterval && ::fdatasync(fd) == 0) {
+                syncedBytes = committedBytes;
+                lastSync = now;
+            }
+        }
+    }
+
+    void commitLocked() {
+        if (pending.empty()) return;
+        for (std::size_t written = 0; written < pending.size();) {
+            ssize_t n = ::write(fd, pending.data() + written, pending.size() - written);
+            if (n < 0) throw std::runtime_error("Ошибка записи в журнал");
+            written += static_cast<std::size_t>(n);
+        }
+        committedBytes += pending.size();
+        pending.clear();
+
+        auto now = std::chrono::steady_clock::now();
+        if (options.fsyncPolicy == FsyncPolicy::ALWAYS ||
+            (options.fsyncPolicy == FsyncPolicy::INTERVAL && now - lastSync >= options.syncInterval)) {
+            sync(now);
+        }
+    }
+
+public:
+    Journal(std::string path, JournalOptions options, std::uint64_t lastSequence, std::uint64_t validLength)
+        : path(std::move(path)), options(options), lastSequence(lastSequence) {
+        open(validLength);
+        if (this->options.fsyncPolicy == FsyncPolicy::INTERVAL) flusher = std::thread([this] { flushLoop(); });
+    }
+
+    ~Journal() {
+        if (flusher.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(fileMutex);
+                stopping = true;
+            }
+            wake.notify_one();
+            flusher.join();
+        }
+        try {
+            std::lock_guard<std::mutex> lock(fileMutex);
+            commitLocked();
+            // Закрытие не оставляет записанных, но не сброшенных групп
+            if (options.fsyncPolicy != FsyncPolicy::NEVER && syncedBytes != committedBytes) {
+                sync(std::chrono::steady_clock::now());
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка: " << e.what() << std::endl;
+        }
+        ::close(fd);
+    }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    static void putU8(std::string& out, std::uint8_t value) { put(out, &value, sizeof(value)); }
+    static void putU32(std::string& out, std::uint32_t value) { put(out, &value, sizeof(value)); }
+
+    static void putString(std::string& out, std::string_view value) {
+        putU32(out, static_cast<std::uint32_t>(value.size()));
+        out.append(value);
+    }
+
+    void append(JournalOp op, std::string_view payload) {
+        std::uint64_t sequence = ++lastSequence;
+        putU32(pending, static_cast<std::uint32_t>(payload.size()));
+        putU32(pending, checksum(sequence, op, payload));
+        put(pending, &sequence, sizeof(sequence));
+        put(pending, &op, sizeof(op));
+        pending.append(payload);
+        if (pending.size() >= options.groupCommitBytes) commit();
+    }
+
+    // Фиксация накопленной группы одним write и, по политике, fdatasync
+    void commit() {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        commitLocked();
+    }
+
+    std::uint64_t sequence() const { return lastSequence; }
+    std::uint64_t size() const { return committedBytes; }
+
+    // Удаление первых length байт, уже вошедших в снимок; хвост переносится в новый файл
+    void dropPrefix(std::uint64_t length) {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        commitLocked();
+        std::string tail(committedBytes - length, '\0');
+        int in = ::open(path.c_str(), O_RDONLY);
+        if (in < 0 || ::pread(in, tail.data(), tail.size(), static_cast<off_t>(length)) !=
+                          static_cast<ssize_t>(tail.size())) {
+            if (in >= 0) ::close(in);
+            throw std::runtime_error("Ошибка чтения журнала");
+        }
+        ::close(in);
+        writeFileAtomically(path, tail);
+        ::close(fd);
+        open(tail.size());
+    }
+
+    // Проигрывание журнала до первой поврежденной записи; возвращает длину корректной части
+    template<typename Callback>
+    static std::uint64_t replay(const std::string& path, Callback&& callback) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return 0;
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string_view view(data);
+
+        std::size_t pos = 0;
+        while (view.size() - pos >= recordHeaderSize) {
+            JournalReader header(view.substr(pos, recordHeaderSize));
+            std::uint32_t length = header.u32();
+            std::uint32_t sum = header.u32();
+            std::uint64_t sequence = header.u64();
+            auto op = static_cast<JournalOp>(header.u8());
+            if (length > view.size() - pos - recordHeaderSize) break;
+            std::string_view payload = view.substr(pos + recordHeaderSize, length);
+            if (checksum(sequence, op, payload) != sum) break;
+            callback(JournalEntry{sequence, op, payload});
+            pos += recordHeaderSize + length;
+        }
+        return pos;
+    }
+};
+
+// Кодек политик для журнала и бинарного снимка
+void encodePolicy(std::string& out, const AccessPolicy& policy) {
+    auto putIds = [&out](const std::vector<int>& ids) {
+        Journal::putU32(out, static_cast<std::uint32_t>(ids.size()));
+        for (int id : ids) Journal::putU32(out, static_cast<std::uint32_t>(id));
+    };
+    putIds(policy.deniedUsers);
+    putIds(policy.allowedUsers);
+    Journal::putU32(out, static_cast<std::uint32_t>(policy.groups.size()));
+    for (const std::string& group : policy.groups) Journal::putString(out, group);
+    Journal::putU32(out, static_cast<std::uint32_t>(policy.windows.size()));
+    for (const TimeWindow& window : policy.windows) {
+        Journal::putU8(out, window.days);
+        Journal::putU32(out, window.from);
+        Journal::putU32(out, window.to);
+    }
+    Journal::putU8(out, policy.levelGrant);
+}
+
+AccessPolicy decodePolicy(JournalReader& reader) {
+    AccessPolicy policy;
+    auto readIds = [&reader](std::vector<int>& ids) {
+        for (std::uint32_t count = reader.u32(); count > 0; --count) ids.push_back(static_cast<int>(reader.u32()));
+    };
+    readIds(policy.deniedUsers);
+    readIds(policy.allowedUsers);
+    for (std::uint32_t count = reader.u32(); count > 0; --count) policy.groups.emplace_back(reader.str());
+    for (std::uint32_t count = reader.u32(); count > 0; --count) {
+        TimeWindow window;
+        window.days = reader.u8();
+        window.from = static_cast<std::uint16_t>(reader.u32());
+        window.to = static_cast<std::uint16_t>(reader.u32());
+        policy.windows.push_back(window);
+    }
+    policy.levelGrant = reader.u8() != 0;
+    return policy;
+}
+
+// Список ID через пробел (текстовый формат и ввод политики)
+std::vector<int> parseIds(const std::string& line) {
+    std::vector<int> ids;
+    std::istringstream in(line);
+    for (int id; in >> id;) ids.push_back(id);
+    return ids;
+}
+
+// nullptr — политика по умолчанию
+const CompiledPolicy* MappedSnapshot::compiledPolicy(const SnapshotResource& resource) const {
+    if (resource.policyLength == 0) return nullptr;
+    std::call_once(policiesCreated, [this] {
+        compiledPolicies = std::make_unique<std::atomic<const CompiledPolicy*>[]>(header().resourceCount);
+    });
+    std::atomic<const CompiledPolicy*>& slot = compiledPolicies[&resource - resources().data()];
+    const CompiledPolicy* compiled = slot.load(std::memory_order_acquire);
+    if (compiled) return compiled;
+
+    // Одновременно скомпилировать политику могут несколько потоков: сохраняется первая копия
+    JournalReader reader(policy(resource));
+    auto fresh = std::make_unique<CompiledPolicy>(decodePolicy(reader), resource.requiredAccess);
+    if (slot.compare_exchange_strong(compiled, fresh.get(), std::memory_order_acq_rel)) return fresh.release();
+    return compiled;
+}
+
+bool MappedSnapshot::checkAccess(int userId, std::string_view resourceName) const {
+    const SnapshotUser* user = findUser(userId);
+    const SnapshotResource* resource = findResource(resourceName);
+    if (!user || !resource) return false;
+    const CompiledPolicy* compiled = compiledPolicy(*resource);
+    if (!compiled) {
+        return static_cast<int>(user->accessLevel) >= static_cast<int>(resource->requiredAccess);
+    }
+    return compiled->decide(user->id, string(user->infoOffset, user->infoLength), user->accessLevel) &&
+           compiled->open();
+}
+
+// Изменения и чтение снимка синхронизированы между собой. Проверки доступа
+// (одиночные и пакетные) и вывод на экран читают только опубликованный снимок
+// и не блокируются пишущим потоком. Поиск пользователей, сохранение в текстовый
+// файл и UserView из findUser обращаются к живым данным и не должны выполняться
+// параллельно с изменениями.
+class AccessControlSystem {
+    // Позиции пользователей и ресурсов не меняются при удалении других элементов
+    UserStore users;
+    SlotMap<Resource> resources;
+
+    // Вторичные индексы, согласованы с users и resources
+    UserIdIndex userIndex;
+    ResourceNameIndex resourceIndex;
+    AccessMatrix accessMatrix;
+    PolicyTable policies;
+    TrigramIndex searchIndex;
+
+    // Снимок для читателей (RCU): пересобирается лениво при первом чтении после изменения
+    mutable std::mutex writeMutex;
+    std::atomic<std::uint64_t> version{0};
+    mutable std::atomic<std::shared_ptr<const AccessSnapshot>> published;
+
+    // Журнал изменений и фоновое сворачивание его в снимок
+    std::unique_ptr<Journal> journal;
+    std::string snapshotPath;
+    std::thread compaction;
+    std::exception_ptr compactionError;
+
+    static constexpr std::size_t npos = UserIdIndex::npos;
+    static constexpr std::size_t batchChunk = 4096; // кратно 64: потоки не делят слова результата
+
+public:
+    AccessControlSystem() = default;
+
+    ~AccessControlSystem() {
+        try {
+            waitCompaction();
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка: " << e.what() << std::endl;
+        }
+    }
+
+    // Объект User служит только источником полей: данные копируются в колоночное хранилище
+    void addUser(std::unique_ptr<User> user) {
+        UserType type = userTypeOf(*user);
+        std::lock_guard<std::mutex> lock(writeMutex);
+        insertUser(type, user->getId(), user->getName(), user->getAdditionalInfo());
+        if (journal) {
+            std::string payload;
+            Journal::putU8(payload, static_cast<std::uint8_t>(type));
+            Journal::putU32(payload, static_cast<std::uint32_t>(user->getId()));
+            Journal::putString(payload, user->getName());
+            Journal::putString(payload, user->getAdditionalInfo());
+            journal->append(JournalOp::ADD_USER, payload);
+        }
+    }
+
+    void addResource(Resource&& resource) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        const Resource& added = insertResource(std::move(resource));
+        if (journal) {
+            std::string payload;
+            Journal::putU8(payload, static_cast<std::uint8_t>(added.getRequiredAccess()));
+            Journal::putString(payload, added.getName());
+            journal->append(JournalOp::ADD_RESOURCE, payload);
+        }
+    }
+
+    void reserve(std::size_t userCount, std::size_t resourceCount) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        users.reserve(userCount);
+        userIndex.reserve(userCount);
+        resources.reserve(resourceCount);
+        resourceIndex.reserve(resourceCount);
+    }
+
+    bool checkAccess(int userId, std::string_view resourceName) const {
+        return snapshot()->checkAccess(userId, resourceName);
+    }
+
+    // Проверка на заданный момент времени (для ресурсов с временными окнами)
+    bool checkAccessAt(int userId, std::string_view resourceName, std::chrono::system_clock::time_point when) const {
+        return snapshot()->checkAccess(userId, resourceName, when);
+    }
+
+    // Политика ресурса компилируется сразу; политика по умолчанию снимает собственную
+    void setPolicy(const std::string& resourceName, AccessPolicy policy) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::size_t resPos = findResourceByName(resourceName);
+        if (resPos == npos) {
+            throw std::invalid_argument("Ресурс не найден");
+        }
+        std::string payload;
+        if (journal) {
+            Journal::putString(payload, resourceName);
+            encodePolicy(payload, policy);
+        }
+        assignPolicy(resPos, std::move(policy));
+        if (journal) journal->append(JournalOp::SET_POLICY, payload);
+    }
+
+    std::optional<AccessPolicy> getPolicy(std::string_view resourceName) const {
+        std::size_t resPos = findResourceByName(resourceName);
+        if (resPos == npos || !policies.isCustom(resPos)) return std::nullopt;
+        return policies.at(resPos).policy();
+    }
+
+    // Пакетная проверка: результат i соответствует запросу i
+    std::vector<bool> checkAccessMany(std::span<const std::pair<int, std::string_view>> requests) const {
+        auto current = snapshot();
+        std::vector<bool> result(requests.size());
+        for (std::size_t i = 0; i < requests.size(); ++i) {
+            result[i] = current->checkAccess(requests[i].first, requests[i].second);
+        }
+        return result;
+    }
+
+    // Текущий снимок; читатель держит его, пока пишущий поток публикует новые
+    std::shared_ptr<const AccessSnapshot> snapshot() const {
+        auto current = published.load(std::memory_order_acquire);
+        if (current && current->version == version.load(std::memory_order_acquire)) {
+            return current;
+        }
+        std::lock_guard<std::mutex> lock(writeMutex);
+        current = published.load();
+        if (!current || current->version != version.load()) {
+            current = buildSnapshot();
+            published.store(current, std::memory_order_release);
+        }
+        return current;
+    }
+
+    // Параллельная пакетная проверка: бит i в result — результат запроса i
+    void checkAccessBatch(std::span<const std::pair<int, std::string_view>> requests,
+                          std::span<std::uint64_t> result, WorkerPool& pool) const {
+        if (result.size() * 64 < requests.size()) {
+            throw std::invalid_argument("Недостаточный размер буфера результатов");
+        }
+        auto current = snapshot();
+        auto when = std::chrono::system_clock::now();
+        std::size_t chunks = (requests.size() + batchChunk - 1) / batchChunk;
+        pool.parallelFor(chunks, [&](std::size_t chunk) {
+            std::size_t begin = chunk * batchChunk;
+            std::size_t end = std::min(begin + batchChunk, requests.size());
+            for (std::size_t word = begin; word < end; word += 64) {
+                std::uint64_t bits = 0;
+                std::size_t wordEnd = std::min(word + 64, end);
+                for (std::size_t i = word; i < wordEnd; ++i) {
+                    bits |= std::uint64_t{current->checkAccess(requests[i].first, requests[i].second, when)} << (i - word);
+                }
+                result[word / 64] = bits;
+            }
+        });
+    }
+
+    void displayAllUsers() const {
+        auto current = snapshot();
+        const UserStore& shown = current->users;
+        if (shown.empty()) {
+            std::cout << "Нет зарегистрированных пользователей.\n";
+            return;
+        }
+        // Порядок вывода — порядок слотов
+        for (std::size_t pos = 0; pos < shown.capacity(); ++pos) {
+            if (shown.alive(pos)) UserView(shown, pos).displayInfo();
+        }
+    }
+
+    void displayAllResources() const {
+        auto current = snapshot();
+        if (current->resources.empty()) {
+            std::cout << "Нет зарегистрированных ресурсов.\n";
+            return;
+        }
+        current->resources.forEach([&current](std::size_t pos, const Resource& resource) {
+            resource.displayInfo();
+            if (current->policies.isCustom(pos)) displayPolicy(current->policies.at(pos).policy());
+        });
+    }
+
+    void saveToFile(const std::string& filename) const {
+        std::ofstream file(filename);
+        if (!file) {
+            throw std::runtime_error("Не удалось открыть файл для записи");
+        }
+
+        // Сохраняем пользователей
+        file << "[Users]\n";
+        for (std::size_t pos = 0; pos < users.capacity(); ++pos) {
+            if (!users.alive(pos)) continue;
+            file << userTypeName(users.type(pos)) << "\n"
+                 << users.name(pos) << "\n"
+                 << users.id(pos) << "\n"
+                 << users.info(pos) << "\n";
+        }
+
+        // Сохраняем ресурсы
+        file << "[Resources]\n";
+        resources.forEach([&file](std::size_t, const Resource& resource) {
+            file << resource.getName() << "\n"
+                 << static_cast<int>(resource.getRequiredAccess()) << "\n";
+        });
+
+        // Сохраняем политики: запреты, разрешения, группы, окна, порядковое правило
+        file << "[Policies]\n";
+        resources.forEach([&](std::size_t pos, const Resource& resource) {
+            if (!policies.isCustom(pos)) return;
+            const AccessPolicy& policy = policies.at(pos).policy();
+            auto writeIds = [&file](const std::vector<int>& ids) {
+                for (std::size_t i = 0; i < ids.size(); ++i) file << (i ? " " : "") << ids[i];
+                file << "\n";
+            };
+            file << resource.getName() << "\n";
+            writeIds(policy.deniedUsers);
+            writeIds(policy.allowedUsers);
+            file << policy.groups.size() << "\n";
+            for (const std::string& group : policy.groups) file << group << "\n";
+            file << policy.windows.size() << "\n";
+            for (const TimeWindow& window : policy.windows) {
+                file << static_cast<int>(window.days) << " " << window.from << " " << window.to << "\n";
+            }
+            file << policy.levelGrant << "\n";
+        });
+    }
+
+    // Бинарный снимок; текстовый формат остается для импорта и экспорта
+    void saveSnapshot(const std::string& filename) const {
+        std::string image;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            image = buildSnapshotImage(journal ? journal->sequence() : 0);
+        }
+        writeFileAtomically(filename, image);
+    }
+
+    void loadSnapshot(const std::string& filename) {
+        MappedSnapshot mapped(filename);
+        waitCompaction();
+
+        std::lock_guard<std::mutex> lock(writeMutex);
+        restoreSnapshot(mapped);
+        if (journal) checkpoint();
+    }
+
+    // Подключение журнала: загрузка последнего снимка и проигрывание журнала поверх него.
+    // Дальнейшие изменения дописываются в журнал, а не переписывают весь снимок
+    void recover(const std::string& snapshotFile, const std::string& journalFile, JournalOptions options = {}) {
+        waitCompaction();
+
+        std::lock_guard<std::mutex> lock(writeMutex);
+        // Журнал может быть тем же файлом: его группа дописывается до проигрывания
+        if (journal) journal->commit();
+
+        // Снимок и журнал загружаются в отдельную систему, и журнал открывается заново
+        // до замены данных: ошибка на середине не затрагивает ни данные, ни текущий журнал
+        AccessControlSystem staging;
+        std::uint64_t sequence = 0;
+        if (std::filesystem::exists(snapshotFile)) {
+            MappedSnapshot mapped(snapshotFile);
+            sequence = staging.restoreSnapshot(mapped);
+        }
+        std::uint64_t validLength = Journal::replay(journalFile, [&](const JournalEntry& entry) {
+            // Записи, уже вошедшие в снимок, пропускаются
+            if (entry.sequence > sequence) {
+                staging.applyJournalEntry(entry);
+                sequence = entry.sequence;
+            }
+        });
+        auto recovered = std::make_unique<Journal>(journalFile, options, sequence, validLength);
+
+        adopt(staging);
+        journal = std::move(recovered);
+        snapshotPath = snapshotFile;
+    }
+
+    // Фиксация накопленной группы записей журнала
+    void commitJournal() {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if (journal) journal->commit();
+    }
+
+    // Фоновое сворачивание журнала в новый снимок. Под одной блокировкой собирается
+    // образ в памяти и запоминаются журнал, его длина и путь снимка, которые этот образ
+    // покрывает; запись файла и усечение журнала выполняются в отдельном потоке.
+    // Записи, добавленные после сборки образа, лежат за запомненной длиной и остаются
+    void compactJournal() {
+        waitCompaction();
+
+        std::string image;
+        std::string path;
+        const Journal* covered;
+        std::uint64_t journalLength;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            if (!journal) throw std::runtime_error("Журнал не подключен");
+            journal->commit();
+            image = buildSnapshotImage(journal->sequence());
+            path = snapshotPath;
+            covered = journal.get();
+            journalLength = journal->size();
+        }
+        compaction = std::thread([this, image = std::move(image), path = std::move(path), covered, journalLength] {
+            try {
+                writeFileAtomically(path, image);
+                std::lock_guard<std::mutex> lock(writeMutex);
+                // Замена журнала ждет сворачивания, поэтому здесь это ошибка, а не гонка
+                if (journal.get() != covered || journal->size() < journalLength) {
+                    throw std::logic_error("Журнал заменен во время сворачивания");
+                }
+                journal->dropPrefix(journalLength);
+            } catch (...) {
+                compactionError = std::current_exception();
+            }
+        });
+    }
 
-public:
-    Administrator(const std::string& name, int id, const std::string& role)
-        : User(name, id, AccessLevel::ADMIN), role(role) {}
+    void waitCompaction() {
+        if (compaction.joinable()) compaction.join();
+        if (compactionError) {
+            std::exception_ptr error = compactionError;
+            compactionError = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
 
-    void displayInfo() const override {
-        User::displayInfo();
-        std::cout << "Роль: " << role << "\n\n";
+    void loadFromFile(const std::string& filename) {
+        std::ifstream file(filename);
+        if (!file) {
+            throw std::runtime_error("Не удалось открыть файл для чтения");
+        }
+        // Файл разбирается в отдельную систему: ошибка на середине файла не затрагивает текущие данные
+        AccessControlSystem staging;
+        staging.parseText(file);
+        waitCompaction();
+
+        std::lock_guard<std::mutex> lock(writeMutex);
+        adopt(staging);
+        if (journal) checkpoint();
     }
 
-    std::string getAdditionalInfo() const override { return role; }
-    std::string getType() const override { return "Administrator"; }
-};
+    // Пользователи, у которых имя, ID или дополнительная информация содержат подстроку
+    std::vector<int> searchUsers(std::string_view searchTerm) const {
+        return search(searchTerm, false);
+    }
 
-class Resource {
-    std::string name;
-    AccessLevel requiredAccess;
+    // Пользователи, у которых одно из полей начинается с prefix
+    std::vector<int> searchUsersByPrefix(std::string_view prefix) const {
+        return search(prefix, true);
+    }
 
-public:
-    Resource(const std::string& name, AccessLevel required)
-        : name(name), requiredAccess(required) {
-        if (name.empty()) throw std::invalid_argument("Имя ресурса не может быть пустым");
+    std::optional<UserView> findUser(int id) const {
+        std::size_t pos = findUserById(id);
+        if (pos == npos) return std::nullopt;
+        return UserView(users, pos);
     }
 
-    bool checkAccess(const User& user) const {
-        return static_cast<int>(user.getAccessLevel()) >= static_cast<int>(requiredAccess);
+    // Устойчивый дескриптор пользователя: перестает действовать после его удаления
+    // и после упаковки хранилища в deleteUsers
+    std::optional<SlotHandle> userHandle(int id) const {
+        std::size_t pos = findUserById(id);
+        if (pos == npos) return std::nullopt;
+        return users.handle(pos);
     }
 
-    std::string getName() const { return name; }
+    std::optional<UserView> findUser(SlotHandle handle) const {
+        if (!users.valid(handle)) return std::nullopt;
+        return UserView(users, handle.slot);
+    }
 
-    AccessLevel getRequiredAccess() const { return requiredAccess; }
+    // ID пользователей с заданным уровнем доступа; проход только по столбцу уровней
+    std::vector<int> filterByLevel(AccessLevel level) const {
+        std::vector<int> ids;
+        auto levels = users.levelColumn();
+        auto allIds = users.idColumn();
+        for (std::size_t pos = 0; pos < levels.size(); ++pos) {
+            if (levels[pos] == level && users.alive(pos)) ids.push_back(allIds[pos]);
+        }
+        return ids;
+    }
 
-    void displayInfo() const {
-        std::cout << "Ресурс: " << name << "\nТребуемый уровень доступа: ";
-        switch(requiredAccess) {
-            case AccessLevel::STUDENT: std::cout << "Студент\n"; break;
-            case AccessLevel::TEACHER: std::cout << "Преподаватель\n"; break;
-            case AccessLevel::ADMIN: std::cout << "Администратор\n"; break;
-            default: std::cout << "Нет доступа\n";
+    bool deleteUser(int id) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if (!eraseUser(id)) return false;
+        if (journal) {
+            std::string payload;
+            Journal::putU32(payload, static_cast<std::uint32_t>(id));
+            journal->append(JournalOp::DELETE_USER, payload);
         }
+        return true;
     }
-};
 
-class AccessControlSystem {
-    std::vector<std::unique_ptr<User>> users;
-    std::vector<Resource> resources;
+    // Массовое удаление: все ID снимаются из индекса поиска разом. Пустые слоты
+    // занимают новые пользователи, поэтому хранилище упаковывается, только когда
+    // пустых слотов становится больше, чем занятых: упаковка переписывает все
+    // столбцы и индекс ID и делает недействительными выданные дескрипторы.
+    // Возвращает число удаленных пользователей
+    std::size_t deleteUsers(std::span<const int> ids) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::size_t deleted = 0;
+        // Снятие четверти пользователей и больше всё равно вызвало бы чистку
+        // индекса, поэтому списки сразу проходятся целиком
+        TrigramIndex::Removal removal(ids.size() * 4 >= users.size());
+        for (int id : ids) {
+            if (!detachUser(id, removal)) continue;
+            ++deleted;
+            if (journal) {
+                std::string payload;
+                Journal::putU32(payload, static_cast<std::uint32_t>(id));
+                journal->append(JournalOp::DELETE_USER, payload);
+            }
+        }
+        searchIndex.erase(removal);
+        if (users.holes() > users.size()) compactUsers();
+        return deleted;
+    }
 
-public:
-    void addUser(std::unique_ptr<User> user) {
-        users.push_back(std::move(user));
+    bool deleteResource(const std::string& name) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if (!eraseResource(name)) return false;
+        if (journal) {
+            std::string payload;
+            Journal::putString(payload, name);
+            journal->append(JournalOp::DELETE_RESOURCE, payload);
+        }
+        return true;
     }
 
-    void addResource(Resource&& resource) {
-        resources.push_back(std::move(resource));
+private:
+    bool eraseUser(int id) {
+        TrigramIndex::Removal removal;
+        if (!detachUser(id, removal)) return false;
+        searchIndex.erase(removal);
+        return true;
     }
 
-    bool checkAccess(int userId, const std::string& resourceName) const {
-        auto userIt = findUserById(userId);
-        auto resIt = findResourceByName(resourceName);
-        
-        if (userIt != users.end() && resIt != resources.end()) {
-            return resIt->checkAccess(**userIt);
+    // Освобождение слота и записи индекса ID; триграммы снимает вызывающий
+    bool detachUser(int id, TrigramIndex::Removal& removal) {
+        std::size_t pos = findUserById(id);
+        if (pos != npos) {
+            ++version;
+            removal.add(id, {users.name(pos), std::to_string(id), users.info(pos)});
+            users.erase(pos);
+            userIndex.erase(id);
+            return true;
         }
         return false;
     }
 
-    void displayAllUsers() const {
-        if (users.empty()) {
-            std::cout << "Нет зарегистрированных пользователей.\n";
-            return;
-        }
-        for (const auto& user : users) {
-            user->displayInfo();
+    bool eraseResource(std::string_view name) {
+        std::size_t pos = findResourceByName(name);
+        if (pos != npos) {
+            ++version;
+            resourceIndex.erase(name);
+            accessMatrix.reset(pos);
+            policies.reset(pos);
+            resources.erase(static_cast<std::uint32_t>(pos));
+            return true;
         }
+        return false;
     }
 
-    void displayAllResources() const {
-        if (resources.empty()) {
-            std::cout << "Нет зарегистрированных ресурсов.\n";
-            return;
-        }
-        for (const auto& resource : resources) {
-            resource.displayInfo();
+    void insertUser(UserType type, int id, std::string_view name, std::string_view info) {
+        validateUser(name, id);
+        if (findUserById(id) != npos) {
+            throw std::invalid_argument("Пользователь с таким ID уже существует");
         }
+        ++version;
+        std::size_t pos = users.insert(type, id, name, info);
+        userIndex.assign(id, pos, users.level(pos), users.infoHandle(pos));
+        searchIndex.insert(id, {name, std::to_string(id), info});
     }
 
-    void saveToFile(const std::string& filename) const {
-        std::ofstream file(filename);
-        if (!file) {
-            throw std::runtime_error("Не удалось открыть файл для записи");
-        }
-
-        // Сохраняем пользователей
-        file << "[Users]\n";
-        for (const auto& user : users) {
-            file << user->getType() << "\n"
-                 << user->getName() << "\n"
-                 << user->getId() << "\n"
-                 << user->getAdditionalInfo() << "\n";
+    const Resource& insertResource(Resource&& resource) {
+        if (findResourceByName(resource.getName()) != npos) {
+            throw std::invalid_argument("Ресурс с таким названием уже существует");
         }
+        ++version;
+        std::uint32_t pos = resources.insert(std::move(resource));
+        resourceIndex.assign(resources[pos].getName(), pos);
+        accessMatrix.assign(pos, resources[pos].getRequiredAccess());
+        return resources[pos];
+    }
 
-        // Сохраняем ресурсы
-        file << "[Resources]\n";
-        for (const auto& resource : resources) {
-            file << resource.getName() << "\n"
-                 << static_cast<int>(resource.getRequiredAccess()) << "\n";
+    // Упаковка слотов пользователей; индекс ID переводится на новые позиции
+    void compactUsers() {
+        ++version;
+        std::vector<std::uint32_t> remap = users.compact();
+        for (std::size_t pos = 0; pos < remap.size(); ++pos) {
+            if (remap[pos] != SlotAllocator::npos && remap[pos] != pos) {
+                std::size_t moved = remap[pos];
+                userIndex.assign(users.id(moved), moved, users.level(moved), users.infoHandle(moved));
+            }
         }
     }
 
-    void loadFromFile(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file) {
-            throw std::runtime_error("Не удалось открыть файл для чтения");
+    void assignPolicy(std::size_t resPos, AccessPolicy policy) {
+        ++version;
+        if (policy.isDefault()) {
+            policies.reset(resPos);
+            return;
         }
+        policies.assign(resPos, CompiledPolicy(std::move(policy), resources[resPos].getRequiredAccess()));
+    }
 
-        users.clear();
-        resources.clear();
-
+    // Разбор текстового формата saveToFile в пустую систему
+    void parseText(std::istream& file) {
         std::string line;
         bool readingUsers = false;
         bool readingResources = false;
+        bool readingPolicies = false;
 
         while (std::getline(file, line)) {
             if (line == "[Users]") {
                 readingUsers = true;
                 readingResources = false;
+                readingPolicies = false;
                 continue;
             }
             if (line == "[Resources]") {
                 readingUsers = false;
                 readingResources = true;
+                readingPolicies = false;
+                continue;
+            }
+            if (line == "[Policies]") {
+                readingUsers = false;
+                readingResources = false;
+                readingPolicies = true;
                 continue;
             }
 
@@ -229,12 +2387,8 @@ public:
                 file.ignore();
                 std::getline(file, additionalInfo);
 
-                if (type == "Student") {
-                    addUser(std::make_unique<Student>(name, id, additionalInfo));
-                } else if (type == "Teacher") {
-                    addUser(std::make_unique<Teacher>(name, id, additionalInfo));
-                } else if (type == "Administrator") {
-                    addUser(std::make_unique<Administrator>(name, id, additionalInfo));
+                if (auto userType = userTypeFromName(type)) {
+                    insertUser(*userType, id, name, additionalInfo);
                 }
             }
             else if (readingResources) {
@@ -243,53 +2397,289 @@ public:
                 file >> accessLevel;
                 file.ignore();
 
-                addResource(Resource(name, static_cast<AccessLevel>(accessLevel)));
+                insertResource(Resource(name, static_cast<AccessLevel>(accessLevel)));
+            }
+            else if (readingPolicies) {
+                std::string name = line;
+                AccessPolicy policy;
+                std::string ids;
+                std::getline(file, ids);
+                policy.deniedUsers = parseIds(ids);
+                std::getline(file, ids);
+                policy.allowedUsers = parseIds(ids);
+
+                std::size_t count = 0;
+                file >> count;
+                file.ignore();
+                for (std::string group; count > 0 && std::getline(file, group); --count) {
+                    policy.groups.push_back(group);
+                }
+                file >> count;
+                for (; count > 0; --count) {
+                    int days, from, to;
+                    file >> days >> from >> to;
+                    policy.windows.push_back({static_cast<std::uint8_t>(days), static_cast<std::uint16_t>(from),
+                                              static_cast<std::uint16_t>(to)});
+                }
+                file >> policy.levelGrant;
+                file.ignore();
+
+                std::size_t resPos = findResourceByName(name);
+                if (resPos != npos) assignPolicy(resPos, std::move(policy));
+            }
+        }
+    }
+
+    // Замена всех данных содержимым other; журнал и снимок для читателей остаются свои
+    void adopt(AccessControlSystem& other) {
+        ++version;
+        std::swap(users, other.users);
+        std::swap(resources, other.resources);
+        std::swap(userIndex, other.userIndex);
+        std::swap(resourceIndex, other.resourceIndex);
+        std::swap(accessMatrix, other.accessMatrix);
+        std::swap(policies, other.policies);
+        std::swap(searchIndex, other.searchIndex);
+    }
+
+    void clearAll() {
+        ++version;
+        users.clear();
+        resources.clear();
+        userIndex.clear();
+        resourceIndex.clear();
+        accessMatrix.clear();
+        policies.clear();
+        searchIndex.clear();
+    }
+
+    void applyJournalEntry(const JournalEntry& entry) {
+        JournalReader reader(entry.payload);
+        switch (entry.op) {
+            case JournalOp::ADD_USER: {
+                auto type = static_cast<UserType>(reader.u8());
+                int id = static_cast<int>(reader.u32());
+                std::string_view name = reader.str();
+                std::string_view info = reader.str();
+                insertUser(type, id, name, info);
+                break;
+            }
+            case JournalOp::DELETE_USER:
+                eraseUser(static_cast<int>(reader.u32()));
+                break;
+            case JournalOp::ADD_RESOURCE: {
+                auto level = static_cast<AccessLevel>(reader.u8());
+                insertResource(Resource(std::string(reader.str()), level));
+                break;
             }
+            case JournalOp::DELETE_RESOURCE:
+                eraseResource(reader.str());
+                break;
+            case JournalOp::SET_POLICY: {
+                std::size_t resPos = findResourceByName(reader.str());
+                AccessPolicy policy = decodePolicy(reader);
+                if (resPos != npos) assignPolicy(resPos, std::move(policy));
+                break;
+            }
+            default:
+                throw std::runtime_error("Поврежденная запись журнала");
         }
     }
 
-    void searchUsers(const std::string& searchTerm) const {
-        bool found = false;
-        for (const auto& user : users) {
-            if (user->getName().find(searchTerm) != std::string::npos ||
-                std::to_string(user->getId()).find(searchTerm) != std::string::npos ||
-                user->getAdditionalInfo().find(searchTerm) != std::string::npos) {
-                user->displayInfo();
-                found = true;
+    // Синхронная контрольная точка после полной замены данных: новый снимок и пустой журнал
+    void checkpoint() {
+        journal->commit();
+        writeFileAtomically(snapshotPath, buildSnapshotImage(journal->sequence()));
+        journal->dropPrefix(journal->size());
+    }
+
+    // Образ бинарного снимка в памяти; вызывается под writeMutex
+    std::string buildSnapshotImage(std::uint64_t journalSequence) const {
+        std::string strings;
+        auto addString = [&strings](std::string_view value, std::uint32_t& offset, std::uint32_t& length) {
+            if (strings.size() + value.size() > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::runtime_error("Слишком большой пул строк для снимка");
+            }
+            offset = static_cast<std::uint32_t>(strings.size());
+            length = static_cast<std::uint32_t>(value.size());
+            strings += value;
+        };
+
+        // Интернированная строка попадает в пул один раз
+        std::unordered_map<StringInterner::Handle, std::pair<std::uint32_t, std::uint32_t>> infoRefs;
+        std::vector<SnapshotUser> userTable;
+        userTable.reserve(users.size());
+        for (std::size_t i = 0; i < users.capacity(); ++i) {
+            if (!users.alive(i)) continue;
+            SnapshotUser& record = userTable.emplace_back();
+            record.id = users.id(i);
+            record.type = users.type(i);
+            record.accessLevel = users.level(i);
+            addString(users.name(i), record.nameOffset, record.nameLength);
+            auto [it, added] = infoRefs.try_emplace(users.infoHandle(i));
+            if (added) addString(users.info(i), it->second.first, it->second.second);
+            record.infoOffset = it->second.first;
+            record.infoLength = it->second.second;
+        }
+
+        std::vector<SnapshotResource> resourceTable;
+        std::vector<std::string_view> resourceNames;
+        std::string policyBlob;
+        resourceTable.reserve(resources.size());
+        resourceNames.reserve(resources.size());
+        resources.forEach([&](std::size_t pos, const Resource& resource) {
+            SnapshotResource& record = resourceTable.emplace_back();
+            record.requiredAccess = resource.getRequiredAccess();
+            addString(resource.getName(), record.nameOffset, record.nameLength);
+            resourceNames.push_back(resource.getName());
+            if (policies.isCustom(pos)) {
+                record.policyOffset = static_cast<std::uint32_t>(policyBlob.size());
+                encodePolicy(policyBlob, policies.at(pos).policy());
+                record.policyLength = static_cast<std::uint32_t>(policyBlob.size() - record.policyOffset);
             }
+        });
+
+        auto byKey = [](const SnapshotKey& a, const SnapshotKey& b) {
+            return a.key != b.key ? a.key < b.key : a.pos < b.pos;
+        };
+        std::vector<SnapshotKey> userById(userTable.size());
+        for (std::size_t i = 0; i < userById.size(); ++i) {
+            userById[i] = {static_cast<std::uint32_t>(userTable[i].id), static_cast<std::uint32_t>(i)};
         }
-        if (!found) {
-            std::cout << "Пользователи не найдены.\n";
+        std::sort(userById.begin(), userById.end(), byKey);
+
+        std::vector<SnapshotKey> resourceByName(resourceTable.size());
+        for (std::size_t i = 0; i < resourceByName.size(); ++i) {
+            resourceByName[i] = {snapshotNameHash(resourceNames[i]), static_cast<std::uint32_t>(i)};
         }
+        std::sort(resourceByName.begin(), resourceByName.end(), byKey);
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+        header.version = snapshotVersion;
+        header.userCount = static_cast<std::uint32_t>(userTable.size());
+        header.resourceCount = static_cast<std::uint32_t>(resourceTable.size());
+
+        std::string image(sizeof(SnapshotHeader), '\0');
+        auto append = [&image](const void* bytes, std::size_t length) {
+            image.resize((image.size() + 7) & ~std::size_t{7}, '\0');
+            std::uint64_t offset = image.size();
+            image.append(static_cast<const char*>(bytes), length);
+            return offset;
+        };
+        header.usersOffset = append(userTable.data(), userTable.size() * sizeof(SnapshotUser));
+        header.resourcesOffset = append(resourceTable.data(), resourceTable.size() * sizeof(SnapshotResource));
+        header.userByIdOffset = append(userById.data(), userById.size() * sizeof(SnapshotKey));
+        header.resourceByNameOffset = append(resourceByName.data(), resourceByName.size() * sizeof(SnapshotKey));
+        header.stringsOffset = append(strings.data(), strings.size());
+        header.stringsSize = strings.size();
+        header.policiesOffset = append(policyBlob.data(), policyBlob.size());
+        header.policiesSize = policyBlob.size();
+        header.fileSize = image.size();
+        header.journalSequence = journalSequence;
+        std::memcpy(image.data(), &header, sizeof(header));
+        return image;
     }
 
-    bool deleteUser(int id) {
-        auto it = findUserById(id);
-        if (it != users.end()) {
-            users.erase(it);
-            return true;
+    // Замена данных содержимым снимка; возвращает номер последней записи журнала в нем
+    std::uint64_t restoreSnapshot(const MappedSnapshot& mapped) {
+        clearAll();
+        users.reserve(mapped.users().size());
+        userIndex.reserve(mapped.users().size());
+        for (const SnapshotUser& record : mapped.users()) {
+            mapped.check(record);
+            insertUser(record.type, record.id, mapped.string(record.nameOffset, record.nameLength),
+                       mapped.string(record.infoOffset, record.infoLength));
         }
-        return false;
+
+        resources.reserve(mapped.resources().size());
+        resourceIndex.reserve(mapped.resources().size());
+        for (const SnapshotResource& record : mapped.resources()) {
+            mapped.check(record);
+            std::string name(mapped.string(record.nameOffset, record.nameLength));
+            insertResource(Resource(name, record.requiredAccess));
+            if (record.policyLength > 0) {
+                JournalReader reader(mapped.policy(record));
+                assignPolicy(findResourceByName(name), decodePolicy(reader));
+            }
+        }
+        return mapped.journalSequence();
     }
 
-    bool deleteResource(const std::string& name) {
-        auto it = findResourceByName(name);
-        if (it != resources.end()) {
-            resources.erase(it);
-            return true;
+    static void displayPolicy(const AccessPolicy& policy) {
+        auto showIds = [](const char* title, const std::vector<int>& ids) {
+            if (ids.empty()) return;
+            std::cout << title;
+            for (int id : ids) std::cout << " " << id;
+            std::cout << "\n";
+        };
+        showIds("Запрещено пользователям:", policy.deniedUsers);
+        showIds("Разрешено пользователям:", policy.allowedUsers);
+        for (const std::string& group : policy.groups) std::cout << "Разрешено группе: " << group << "\n";
+        for (const TimeWindow& window : policy.windows) {
+            std::cout << "Окно доступа: " << window.from / 60 << ":" << window.from % 60 / 10 << window.from % 10
+                      << "-" << window.to / 60 << ":" << window.to % 60 / 10 << window.to % 10 << "\n";
+        }
+        if (!policy.levelGrant) std::cout << "Доступ по уровню отключен\n";
+    }
+
+    static UserType userTypeOf(const User& user) {
+        if (auto type = userTypeFromName(user.getType())) return *type;
+        throw std::invalid_argument("Неизвестный тип пользователя");
+    }
+
+    // Вызывается под writeMutex
+    std::shared_ptr<const AccessSnapshot> buildSnapshot() const {
+        auto next = std::make_shared<AccessSnapshot>();
+        next->version = version.load();
+        next->users = users;
+        next->resources = resources;
+        next->userIndex = userIndex;
+        next->resourceIndex = resourceIndex;
+        next->accessMatrix = accessMatrix;
+        next->policies = policies;
+        return next;
+    }
+
+    bool matches(std::size_t pos, std::string_view term, bool prefix) const {
+        char buffer[16];
+        std::string_view id(buffer, std::to_chars(buffer, buffer + sizeof(buffer), users.id(pos)).ptr - buffer);
+        for (std::string_view field : {users.name(pos), id, users.info(pos)}) {
+            if (prefix ? field.substr(0, term.size()) == term : field.find(term) != std::string_view::npos) {
+                return true;
+            }
         }
         return false;
     }
 
-private:
-    std::vector<std::unique_ptr<User>>::const_iterator findUserById(int id) const {
-        return std::find_if(users.begin(), users.end(),
-            [id](const auto& u) { return u->getId() == id; });
+    std::vector<int> search(std::string_view term, bool prefix) const {
+        std::vector<std::size_t> found;
+        std::vector<int> candidates;
+        if (searchIndex.candidates(term, prefix, candidates)) {
+            for (int id : candidates) {
+                std::size_t pos = findUserById(id);
+                if (matches(pos, term, prefix)) found.push_back(pos);
+            }
+            // Порядок результатов совпадает с порядком слотов пользователей
+            std::sort(found.begin(), found.end());
+        } else {
+            for (std::size_t pos = 0; pos < users.capacity(); ++pos) {
+                if (users.alive(pos) && matches(pos, term, prefix)) found.push_back(pos);
+            }
+        }
+
+        std::vector<int> ids;
+        ids.reserve(found.size());
+        for (std::size_t pos : found) ids.push_back(users.id(pos));
+        return ids;
+    }
+
+    std::size_t findUserById(int id) const {
+        return userIndex.find(id);
     }
 
-    std::vector<Resource>::const_iterator findResourceByName(const std::string& name) const {
-        return std::find_if(resources.begin(), resources.end(),
-            [name](const auto& r) { return r.getName() == name; });
+    std::size_t findResourceByName(std::string_view name) const {
+        return resourceIndex.find(name);
     }
 };
 
@@ -306,6 +2696,12 @@ void displayMenu() {
     std::cout << "8. Удалить ресурс\n";
     std::cout << "9. Сохранить данные\n";
     std::cout << "10. Загрузить данные\n";
+    std::cout << "11. Сохранить бинарный снимок\n";
+    std::cout << "12. Загрузить бинарный снимок\n";
+    std::cout << "13. Подключить журнал изменений\n";
+    std::cout << "14. Свернуть журнал в снимок\n";
+    std::cout << "15. Поиск пользователей по префиксу\n";
+    std::cout << "16. Настроить политику ресурса\n";
     std::cout << "0. Выход\n";
     std::cout << "Выберите действие: ";
 }
@@ -407,12 +2803,30 @@ void checkAccessInteractive(const AccessControlSystem& system) {
     std::cout << "Доступ: " << (hasAccess ? "Разрешен" : "Запрещен") << std::endl;
 }
 
+void displaySearchResults(const AccessControlSystem& system, const std::vector<int>& ids) {
+    if (ids.empty()) {
+        std::cout << "Пользователи не найдены.\n";
+        return;
+    }
+    for (int id : ids) {
+        system.findUser(id)->displayInfo();
+    }
+}
+
 void searchUsersInteractive(const AccessControlSystem& system) {
     std::string searchTerm;
     std::cout << "Введите поисковый запрос (имя, ID или дополнительную информацию): ";
     std::cin.ignore();
     std::getline(std::cin, searchTerm);
-    system.searchUsers(searchTerm);
+    displaySearchResults(system, system.searchUsers(searchTerm));
+}
+
+void searchUsersByPrefixInteractive(const AccessControlSystem& system) {
+    std::string prefix;
+    std::cout << "Введите начало имени, ID или дополнительной информации: ";
+    std::cin.ignore();
+    std::getline(std::cin, prefix);
+    displaySearchResults(system, system.searchUsersByPrefix(prefix));
 }
 
 void deleteUserInteractive(AccessControlSystem& system) {
@@ -472,7 +2886,534 @@ void loadDataInteractive(AccessControlSystem& system) {
     }
 }
 
-int main() {
+void saveSnapshotInteractive(const AccessControlSystem& system) {
+    std::string filename;
+    std::cout << "Введите имя файла снимка: ";
+    std::cin.ignore();
+    std::getline(std::cin, filename);
+
+    try {
+        system.saveSnapshot(filename);
+        std::cout << "Снимок успешно сохранен в файл " << filename << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка при сохранении: " << e.what() << std::endl;
+    }
+}
+
+void loadSnapshotInteractive(AccessControlSystem& system) {
+    std::string filename;
+    std::cout << "Введите имя файла снимка: ";
+    std::cin.ignore();
+    std::getline(std::cin, filename);
+
+    try {
+        system.loadSnapshot(filename);
+        std::cout << "Снимок успешно загружен из файла " << filename << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка при загрузке: " << e.what() << std::endl;
+    }
+}
+
+void recoverInteractive(AccessControlSystem& system) {
+    std::string snapshotFile, journalFile;
+    std::cout << "Введите имя файла снимка: ";
+    std::cin.ignore();
+    std::getline(std::cin, snapshotFile);
+    std::cout << "Введите имя файла журнала: ";
+    std::getline(std::cin, journalFile);
+
+    try {
+        system.recover(snapshotFile, journalFile);
+        std::cout << "Данные восстановлены, изменения записываются в журнал " << journalFile << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка при восстановлении: " << e.what() << std::endl;
+    }
+}
+
+void compactJournalInteractive(AccessControlSystem& system) {
+    try {
+        system.compactJournal();
+        std::cout << "Сворачивание журнала запущено в фоне.\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+    }
+}
+
+void setPolicyInteractive(AccessControlSystem& system) {
+    std::string name, line;
+    AccessPolicy policy;
+
+    std::cout << "Название ресурса: ";
+    std::cin.ignore();
+    std::getline(std::cin, name);
+
+    std::cout << "ID пользователей, которым доступ запрещен (через пробел): ";
+    std::getline(std::cin, line);
+    policy.deniedUsers = parseIds(line);
+    std::cout << "ID пользователей, которым доступ разрешен (через пробел): ";
+    std::getline(std::cin, line);
+    policy.allowedUsers = parseIds(line);
+
+    std::cout << "Группы, кафедры или роли с доступом (через запятую): ";
+    std::getline(std::cin, line);
+    std::istringstream groups(line);
+    for (std::string group; std::getline(groups, group, ',');) {
+        group.erase(0, group.find_first_not_of(' '));
+        group.erase(group.find_last_not_of(' ') + 1);
+        if (!group.empty()) policy.groups.push_back(group);
+    }
+
+    std::cout << "Окно доступа ЧЧ:ММ-ЧЧ:ММ (пусто — круглосуточно): ";
+    std::getline(std::cin, line);
+    if (!line.empty()) {
+        std::istringstream in(line);
+        int fromHour, fromMinute, toHour, toMinute;
+        char colon1, dash, colon2;
+        if (!(in >> fromHour >> colon1 >> fromMinute >> dash >> toHour >> colon2 >> toMinute) ||
+            fromHour < 0 || fromHour > 24 || toHour < 0 || toHour > 24 ||
+            fromMinute < 0 || fromMinute > 59 || toMinute < 0 || toMinute > 59) {
+            std::cerr << "Ошибка: неверный формат окна доступа" << std::endl;
+            return;
+        }
+        TimeWindow window;
+        window.from = static_cast<std::uint16_t>(fromHour * 60 + fromMinute);
+        window.to = static_cast<std::uint16_t>(toHour * 60 + toMinute);
+        policy.windows.push_back(window);
+    }
+
+    int levelGrant;
+    std::cout << "Сохранить доступ по уровню? (1 — да, 0 — нет): ";
+    while (!(std::cin >> levelGrant) || (levelGrant != 0 && levelGrant != 1)) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Неверный ввод. Введите 0 или 1: ";
+    }
+    policy.levelGrant = levelGrant == 1;
+
+    try {
+        system.setPolicy(name, std::move(policy));
+        std::cout << "Политика ресурса обновлена.\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+    }
+}
+
+// Заполнение системы синтетическими данными для замеров
+void fillBenchmarkData(AccessControlSystem& system, int userCount, int resourceCount) {
+    system.reserve(userCount, resourceCount);
+    for (int id = 1; id <= userCount; ++id) {
+        std::string name = "User" + std::to_string(id);
+        switch (id % 3) {
+            case 0: system.addUser(std::make_unique<Student>(name, id, "Group" + std::to_string(id % 300))); break;
+            case 1: system.addUser(std::make_unique<Teacher>(name, id, "Department" + std::to_string(id % 40))); break;
+            case 2: system.addUser(std::make_unique<Administrator>(name, id, "Role" + std::to_string(id % 10))); break;
+        }
+    }
+    for (int i = 1; i <= resourceCount; ++i) {
+        system.addResource(Resource("Resource" + std::to_string(i), static_cast<AccessLevel>(1 + i % 3)));
+    }
+}
+
+// Время одной проверки доступа при росте числа пользователей и ресурсов
+void benchmarkCheckAccess() {
+    const int queryCount = 1 << 20;
+    std::cout << "checkAccess:\n";
+    for (int userCount : {1000, 10000, 50000, 200000}) {
+        int resourceCount = userCount / 4;
+        AccessControlSystem system;
+        fillBenchmarkData(system, userCount, resourceCount);
+
+        std::mt19937 rng(42);
+        std::vector<std::pair<int, std::string>> queries;
+        queries.reserve(queryCount);
+        for (int i = 0; i < queryCount; ++i) {
+            int id = 1 + static_cast<int>(rng() % userCount);
+            queries.emplace_back(id, "Resource" + std::to_string(1 + rng() % resourceCount));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::size_t granted = 0;
+        for (const auto& [id, resource] : queries) {
+            granted += system.checkAccess(id, resource);
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "  пользователей: " << userCount << ", ресурсов: " << resourceCount
+                  << ", нс на проверку: " << elapsed.count() / queryCount
+                  << " (разрешено " << granted << ")\n";
+    }
+}
+
+// Проверка доступа к ресурсам с собственными политиками: скомпилированная программа
+// против проверки исходных правил со сравнением строк. Полная проверка включает поиск
+// пользователя и ресурса, поэтому само решение замеряется и отдельно, по заранее
+// найденным записям. Каждый замер — лучший из нескольких прогонов
+void benchmarkPolicies() {
+    const int userCount = 200000;
+    const int resourceCount = 1000;
+    const int queryCount = 1 << 20;
+    const int runs = 5;
+    AccessControlSystem system;
+    fillBenchmarkData(system, userCount, resourceCount);
+
+    std::mt19937 rng(42);
+    std::vector<std::pair<int, std::string>> queries;
+    queries.reserve(queryCount);
+    for (int i = 0; i < queryCount; ++i) {
+        queries.emplace_back(1 + static_cast<int>(rng() % userCount), "Resource" + std::to_string(1 + rng() % resourceCount));
+    }
+    auto measure = [&](auto check) {
+        double best = std::numeric_limits<double>::max();
+        std::size_t granted = 0;
+        for (int run = 0; run < runs; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            granted = 0;
+            for (const auto& [id, resource] : queries) granted += check(id, resource);
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count() / queryCount);
+        }
+        return std::pair(best, granted);
+    };
+    auto checkLive = [&](int id, const std::string& resource) { return system.checkAccess(id, resource); };
+    auto [ordinalNs, ordinalGranted] = measure(checkLive);
+
+    std::vector<AccessPolicy> rules(resourceCount + 1);
+    for (int i = 1; i <= resourceCount; ++i) {
+        AccessPolicy& policy = rules[i];
+        for (int k = 0; k < 20; ++k) policy.deniedUsers.push_back(1 + static_cast<int>(rng() % userCount));
+        for (int k = 0; k < 20; ++k) policy.allowedUsers.push_back(1 + static_cast<int>(rng() % userCount));
+        policy.groups = {"Group" + std::to_string(i % 300), "Department" + std::to_string(i % 40)};
+        system.setPolicy("Resource" + std::to_string(i), policy);
+    }
+    auto required = [](std::size_t rule) { return static_cast<AccessLevel>(1 + rule % 3); };
+
+    auto [compiledNs, compiledGranted] = measure(checkLive);
+
+    std::string snapshotFile = (std::filesystem::temp_directory_path() / "acs_bench_policies.snap").string();
+    system.saveSnapshot(snapshotFile);
+    std::pair<double, std::size_t> mapped;
+    {
+        MappedSnapshot snapshot(snapshotFile);
+        mapped = measure([&](int id, const std::string& resource) { return snapshot.checkAccess(id, resource); });
+    }
+    std::filesystem::remove(snapshotFile);
+
+    // Те же поиски пользователя и ресурса, что и в checkAccess: правило находится
+    // по имени через такой же индекс, отличается только само решение
+    std::vector<std::string> ruleNames(resourceCount + 1);
+    ResourceNameIndex ruleIndex;
+    ruleIndex.reserve(resourceCount);
+    for (int i = 1; i <= resourceCount; ++i) {
+        ruleNames[i] = "Resource" + std::to_string(i);
+        ruleIndex.assign(ruleNames[i], i);
+    }
+    auto [interpretedNs, interpretedGranted] = measure([&](int id, const std::string& resource) {
+        auto user = system.findUser(id);
+        std::size_t rule = ruleIndex.find(resource);
+        if (!user || rule == ResourceNameIndex::npos) return false;
+        return rules[rule].grants(id, user->getAdditionalInfo(), user->getAccessLevel(), required(rule));
+    });
+
+    // Только решение: пользователь, ресурс и политика найдены заранее
+    struct Resolved {
+        int id;
+        AccessLevel level;
+        StringInterner::Handle infoHandle;
+        std::string_view info;
+        std::size_t rule;
+    };
+    std::vector<CompiledPolicy> programs;
+    programs.reserve(resourceCount + 1);
+    for (int i = 0; i <= resourceCount; ++i) programs.emplace_back(rules[i], required(i));
+    std::vector<Resolved> resolved;
+    resolved.reserve(queryCount);
+    for (const auto& [id, resource] : queries) {
+        auto user = system.findUser(id);
+        resolved.push_back({id, user->getAccessLevel(), *StringInterner::global().find(user->getAdditionalInfo()),
+                            user->getAdditionalInfo(), ruleIndex.find(resource)});
+    }
+    auto decideOnly = [&](auto decide) {
+        double best = std::numeric_limits<double>::max();
+        for (int run = 0; run < runs; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            std::size_t granted = 0;
+            for (const Resolved& query : resolved) granted += decide(query);
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count() / queryCount);
+            if (granted != compiledGranted) throw std::logic_error("Решения политик разошлись");
+        }
+        return best;
+    };
+    double programNs = decideOnly([&](const Resolved& query) {
+        return programs[query.rule].decide(query.id, query.infoHandle, query.level);
+    });
+    double rulesNs = decideOnly([&](const Resolved& query) {
+        return rules[query.rule].grants(query.id, query.info, query.level, required(query.rule));
+    });
+
+    std::cout << "Политики доступа (" << resourceCount << " ресурсов, лучший из " << runs << " прогонов):\n"
+              << "  только уровни: " << ordinalNs << " нс на проверку (разрешено " << ordinalGranted << ")\n"
+              << "  скомпилированные: " << compiledNs << " нс на проверку (разрешено " << compiledGranted << ")\n"
+              << "  скомпилированные, по отображенному снимку: " << mapped.first << " нс на проверку (разрешено "
+              << mapped.second << ")\n"
+              << "  разбор правил: " << interpretedNs << " нс на проверку (разрешено " << interpretedGranted << ")\n"
+              << "  только решение: программа " << programNs << " нс, разбор правил " << rulesNs << " нс\n";
+}
+
+// Пакетная проверка через checkAccessMany
+void benchmarkCheckAccessMany() {
+    const int userCount = 200000;
+    const int resourceCount = 50000;
+    const int queryCount = 1 << 20;
+    AccessControlSystem system;
+    fillBenchmarkData(system, userCount, resourceCount);
+
+    std::mt19937 rng(42);
+    std::vector<std::string> names;
+    names.reserve(resourceCount);
+    for (int i = 1; i <= resourceCount; ++i) names.push_back("Resource" + std::to_string(i));
+    std::vector<std::pair<int, std::string_view>> queries;
+    queries.reserve(queryCount);
+    for (int i = 0; i < queryCount; ++i) {
+        queries.emplace_back(1 + static_cast<int>(rng() % userCount), names[rng() % resourceCount]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<bool> result = system.checkAccessMany(queries);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "checkAccessMany:\n  запросов: " << queryCount
+              << ", нс на проверку: " << elapsed.count() / queryCount
+              << " (разрешено " << std::count(result.begin(), result.end(), true) << ")\n";
+}
+
+// Пропускная способность checkAccessBatch от 1 до N потоков
+void benchmarkCheckAccessBatch() {
+    const int userCount = 200000;
+    const int resourceCount = 50000;
+    const int queryCount = 1 << 20;
+    const int rounds = 8;
+    AccessControlSystem system;
+    fillBenchmarkData(system, userCount, resourceCount);
+
+    std::mt19937 rng(42);
+    std::vector<std::string> names;
+    names.reserve(resourceCount);
+    for (int i = 1; i <= resourceCount; ++i) names.push_back("Resource" + std::to_string(i));
+    std::vector<std::pair<int, std::string_view>> queries;
+    queries.reserve(queryCount);
+    for (int i = 0; i < queryCount; ++i) {
+        queries.emplace_back(1 + static_cast<int>(rng() % userCount), names[rng() % resourceCount]);
+    }
+    std::vector<std::uint64_t> result((queryCount + 63) / 64);
+    system.snapshot(); // сборка снимка не входит в замер
+
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "checkAccessBatch:\n";
+    for (unsigned threadCount = 1; threadCount <= maxThreads; ++threadCount) {
+        WorkerPool pool(threadCount);
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            system.checkAccessBatch(queries, result, pool);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  потоков: " << threadCount << ", млн проверок в секунду: "
+                  << static_cast<double>(queryCount) * rounds / elapsed.count() / 1e6 << "\n";
+    }
+}
+
+// Время загрузки: текстовый формат против бинарного снимка
+void benchmarkLoad() {
+    const int userCount = 200000;
+    const int resourceCount = 50000;
+    auto directory = std::filesystem::temp_directory_path();
+    std::string textFile = (directory / "acs_bench.txt").string();
+    std::string snapshotFile = (directory / "acs_bench.snap").string();
+    {
+        AccessControlSystem system;
+        fillBenchmarkData(system, userCount, resourceCount);
+        system.saveToFile(textFile);
+        system.saveSnapshot(snapshotFile);
+    }
+
+    auto measure = [](auto&& action) {
+        auto start = std::chrono::steady_clock::now();
+        action();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    };
+
+    AccessControlSystem textSystem;
+    double textMs = measure([&] { textSystem.loadFromFile(textFile); });
+    AccessControlSystem snapshotSystem;
+    double snapshotMs = measure([&] { snapshotSystem.loadSnapshot(snapshotFile); });
+    bool granted = false;
+    double mappedMs = measure([&] {
+        MappedSnapshot mapped(snapshotFile);
+        granted = mapped.checkAccess(userCount, "Resource1");
+    });
+
+    std::cout << "Загрузка " << userCount << " пользователей и " << resourceCount << " ресурсов:\n"
+              << "  текст: " << textMs << " мс\n"
+              << "  бинарный снимок с созданием объектов: " << snapshotMs << " мс\n"
+              << "  бинарный снимок, отображение и одна проверка: " << mappedMs
+              << " мс (доступ " << (granted ? "разрешен" : "запрещен") << ")\n";
+
+    std::filesystem::remove(textFile);
+    std::filesystem::remove(snapshotFile);
+}
+
+// Стоимость сохранения одного изменения: полная перезапись против журнала
+void benchmarkJournal() {
+    const int userCount = 200000;
+    const int resourceCount = 50000;
+    const int edits = 200;
+    auto directory = std::filesystem::temp_directory_path();
+    std::string textFile = (directory / "acs_bench.txt").string();
+    std::string snapshotFile = (directory / "acs_bench.snap").string();
+    std::string journalFile = (directory / "acs_bench.journal").string();
+    std::filesystem::remove(snapshotFile);
+    std::filesystem::remove(journalFile);
+
+    AccessControlSystem system;
+    fillBenchmarkData(system, userCount, resourceCount);
+    system.saveSnapshot(snapshotFile);
+
+    int next = 0;
+    auto measure = [&](auto&& persist) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < edits; ++i) {
+            system.addResource(Resource("Edit" + std::to_string(next++), AccessLevel::TEACHER));
+            persist();
+        }
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / edits;
+    };
+
+    double rewriteUs = measure([&] { system.saveToFile(textFile); });
+    std::cout << "Сохранение одного изменения (" << userCount << " пользователей):\n"
+              << "  перезапись текстового файла: " << rewriteUs << " мкс\n";
+
+    for (FsyncPolicy policy : {FsyncPolicy::NEVER, FsyncPolicy::INTERVAL, FsyncPolicy::ALWAYS}) {
+        JournalOptions options;
+        options.fsyncPolicy = policy;
+        system.recover(snapshotFile, journalFile, options);
+        double journalUs = measure([&] { system.commitJournal(); });
+        const char* label = policy == FsyncPolicy::ALWAYS ? "на каждую группу"
+                          : policy == FsyncPolicy::INTERVAL ? "раз в syncInterval" : "выключен";
+        std::cout << "  журнал, fsync " << label << ": " << journalUs << " мкс\n";
+        system.compactJournal();
+        system.waitCompaction();
+    }
+
+    std::filesystem::remove(textFile);
+    std::filesystem::remove(snapshotFile);
+    std::filesystem::remove(journalFile);
+}
+
+// Время поиска пользователей по подстроке и префиксу
+void benchmarkSearch() {
+    const int userCount = 200000;
+    AccessControlSystem system;
+    fillBenchmarkData(system, userCount, 0);
+
+    std::cout << "Поиск среди " << userCount << " пользователей:\n";
+    auto run = [&](const char* kind, std::string_view term, bool prefix) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<int> ids = prefix ? system.searchUsersByPrefix(term) : system.searchUsers(term);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  " << kind << " \"" << term << "\": " << elapsed.count()
+                  << " мс, найдено " << ids.size() << "\n";
+    };
+    run("подстрока", "12345", false);
+    run("подстрока", "Role7", false);
+    run("префикс", "User1999", true);
+    run("подстрока (без индекса)", "77", false);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> teachers = system.filterByLevel(AccessLevel::TEACHER);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "  фильтр по уровню доступа: " << elapsed.count()
+              << " мс, найдено " << teachers.size() << "\n";
+}
+
+// Отчисление выпуска: удаление 30 тыс. студентов по одному и одним пакетом
+void benchmarkDeleteUsers() {
+    const int userCount = 90000;
+    std::cout << "Удаление студентов среди " << userCount << " пользователей:\n";
+    for (bool bulk : {false, true}) {
+        AccessControlSystem system;
+        fillBenchmarkData(system, userCount, 1000);
+        std::vector<int> students = system.filterByLevel(AccessLevel::STUDENT);
+
+        auto start = std::chrono::steady_clock::now();
+        if (bulk) {
+            system.deleteUsers(students);
+        } else {
+            for (int id : students) system.deleteUser(id);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  " << (bulk ? "deleteUsers" : "deleteUser по одному") << ": " << elapsed.count()
+                  << " мс, удалено " << students.size() << "\n";
+    }
+}
+
+// Память на 1 млн пользователей: объекты User со своими строками против колонок
+// с интернированными группами, кафедрами и ролями
+void benchmarkMemory() {
+    const int userCount = 1000000;
+    // Служебный заголовок блока malloc и выравнивание до 16 байт
+    auto heapBlock = [](std::size_t size) { return (size + 8 + 15) / 16 * 16; };
+    auto stringHeap = [&](const std::string& value) {
+        return value.capacity() > 15 ? heapBlock(value.capacity() + 1) : 0;
+    };
+
+    std::size_t internedBefore = StringInterner::global().memoryUsage();
+    UserStore store;
+    store.reserve(userCount);
+    std::size_t legacyBytes = userCount * sizeof(std::unique_ptr<User>);
+    for (int id = 1; id <= userCount; ++id) {
+        std::string name = "Пользователь " + std::to_string(id);
+        std::string info;
+        UserType type;
+        switch (id % 3) {
+            case 0: type = UserType::STUDENT; info = "Группа ИВТ-" + std::to_string(id % 300); break;
+            case 1: type = UserType::TEACHER; info = "Кафедра № " + std::to_string(id % 40); break;
+            default: type = UserType::ADMINISTRATOR; info = "Роль " + std::to_string(id % 10); break;
+        }
+        // Прежний Student: поля User и собственная строка группы
+        legacyBytes += heapBlock(sizeof(User) + sizeof(std::string)) + stringHeap(name) + stringHeap(info);
+        store.insert(type, id, name, info);
+    }
+    std::size_t columnBytes = store.memoryUsage();
+    std::size_t internedBytes = StringInterner::global().memoryUsage() - internedBefore;
+
+    std::cout << "Память на " << userCount << " пользователей:\n"
+              << "  объекты User со строками (оценка): " << legacyBytes / (1024 * 1024) << " МБ, "
+              << legacyBytes / userCount << " байт на пользователя\n"
+              << "  колонки с интернированием: " << (columnBytes + internedBytes) / (1024 * 1024) << " МБ, "
+              << (columnBytes + internedBytes) / userCount << " байт на пользователя (таблица строк "
+              << internedBytes / 1024 << " КБ)\n";
+}
+
+void runBenchmarks() {
+    benchmarkCheckAccess();
+    benchmarkPolicies();
+    benchmarkCheckAccessMany();
+    benchmarkCheckAccessBatch();
+    benchmarkLoad();
+    benchmarkJournal();
+    benchmarkSearch();
+    benchmarkDeleteUsers();
+    benchmarkMemory();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmarks();
+        return 0;
+    }
+
     AccessControlSystem system;
     int choice;
 
@@ -496,9 +3437,17 @@ int main() {
                 case 8: deleteResourceInteractive(system); break;
                 case 9: saveDataInteractive(system); break;
                 case 10: loadDataInteractive(system); break;
+                case 11: saveSnapshotInteractive(system); break;
+                case 12: loadSnapshotInteractive(system); break;
+                case 13: recoverInteractive(system); break;
+                case 14: compactJournalInteractive(system); break;
+                case 15: searchUsersByPrefixInteractive(system); break;
+                case 16: setPolicyInteractive(system); break;
                 case 0: std::cout << "Выход из программы.\n"; break;
                 default: std::cout << "Неверный выбор. Попробуйте снова.\n";
             }
+            // Каждое действие меню — одна группа записей журнала
+            system.commitJournal();
         } catch (const std::exception& e) {
             std::cerr << "Ошибка: " << e.what() << std::endl;
         }
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <deque>
+#include <optional>
+#include <string>
 
 // Шаблонный класс Queue
 template <typename T>
@@ -13,11 +15,25 @@ public:
         elements.push_back(item);
     }
 
-    // Удаление элемента из начала очереди
-    void pop() {
-        if (!elements.empty()) {
-            elements.pop_front();
+    // Добавление элемента перемещением, без копии
+    void push(T&& item) {
+        elements.push_back(std::move(item));
+    }
+
+    // Создание элемента прямо в конце очереди
+    template <typename... Args>
+    T& emplace(Args&&... args) {
+        return elements.emplace_back(std::forward<Args>(args)...);
+    }
+
+    // Извлечение первого элемента перемещением; для пустой очереди - std::nullopt
+    std::optional<T> pop() {
+        if (elements.empty()) {
+            return std::nullopt;
         }
+        std::optional<T> item(std::move(elements.front()));
+        elements.pop_front();
+        return item;
     }
 
     // Получение первого элемента очереди
@@ -34,14 +50,13 @@ public:
 int main() {
     // Тестирование очереди для строк
     Queue<std::string> stringQueue;
-    stringQueue.push("First");
-    stringQueue.push("Second");
-    stringQueue.push("Third");
+    stringQueue.emplace("First");
+    stringQueue.emplace("Second");
+    stringQueue.emplace("Third");
 
     std::cout << "String Queue:" << std::endl;
-    while (!stringQueue.empty()) {
-        std::cout << stringQueue.front() << std::endl;
-        stringQueue.pop();
+    while (std::optional<std::string> item = stringQueue.pop()) {
+        std::cout << *item << std::endl;
     }
 
     // Тестирование очереди для целых чисел
@@ -1,27 +1,179 @@
 #include <iostream>
 #include <deque>
+#include <memory_resource>
 #include <stdexcept>
+#include <string>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <algorithm>
 
-template <typename T>
+// Политики доступа к первому элементу: CheckedAccess бросает исключение на пустой
+// очереди, UncheckedAccess оставляет проверку вызывающему (для горячих циклов)
+struct CheckedAccess {
+    static constexpr bool checked = true;
+};
+
+struct UncheckedAccess {
+    static constexpr bool checked = false;
+};
+
+// Кольцевой буфер со степенью двойки в качестве ёмкости; при заполнении удваивается.
+// Первые InlineCapacity элементов живут прямо в объекте, в кучу (через memory_resource)
+// буфер уходит только при переполнении.
+template <typename T, std::size_t InlineCapacity = 0>
+class RingBuffer {
+private:
+    static_assert(InlineCapacity == 0 || std::has_single_bit(InlineCapacity),
+                  "Inline capacity must be a power of two");
+
+    std::pmr::polymorphic_allocator<T> allocator;
+    alignas(T) unsigned char inlineStorage[InlineCapacity == 0 ? 1 : InlineCapacity * sizeof(T)];
+    T* slots;
+    std::size_t capacity = InlineCapacity;
+    std::size_t head = 0;
+    std::size_t count = 0;
+
+    T* inlineSlots() {
+        return InlineCapacity == 0 ? nullptr : std::launder(reinterpret_cast<T*>(inlineStorage));
+    }
+
+    T& at(std::size_t index) {
+        return slots[(head + index) & (capacity - 1)];
+    }
+
+    void grow() {
+        const std::size_t grown = capacity == 0 ? 8 : capacity * 2;
+        T* fresh = allocator.allocate(grown);
+        for (std::size_t i = 0; i < count; ++i) {
+            new (fresh + i) T(std::move_if_noexcept(at(i)));
+            at(i).~T();
+        }
+        if (slots != inlineSlots()) {
+            allocator.deallocate(slots, capacity);
+        }
+        slots = fresh;
+        capacity = grown;
+        head = 0;
+    }
+
+public:
+    explicit RingBuffer(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : allocator(resource), slots(inlineSlots()) {}
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    ~RingBuffer() {
+        clear();
+        if (slots != inlineSlots()) {
+            allocator.deallocate(slots, capacity);
+        }
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (count == capacity) {
+            grow();
+        }
+        T* slot = &slots[(head + count) & (capacity - 1)];
+        new (slot) T(std::forward<Args>(args)...);
+        ++count;
+        return *slot;
+    }
+
+    T& front() {
+        return slots[head];
+    }
+
+    void pop_front() {
+        slots[head].~T();
+        head = (head + 1) & (capacity - 1);
+        --count;
+    }
+
+    void clear() {
+        while (count > 0) {
+            pop_front();
+        }
+        head = 0;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+};
+
+// Политики хранения элементов Queue<T>. Все контейнеры берут память из
+// std::pmr::memory_resource, поэтому очередь на один тик можно разместить в арене
+// и освободить её целиком одним release().
+struct DequeStorage {
+    template <typename T>
+    using type = std::pmr::deque<T>;
+};
+
+struct RingStorage {
+    template <typename T>
+    using type = RingBuffer<T>;
+};
+
+template <std::size_t N>
+struct SmallStorage {
+    template <typename T>
+    using type = RingBuffer<T, N>;
+};
+
+template <typename T, typename Access = CheckedAccess, typename Storage = DequeStorage>
 class Queue {
 private:
-    std::deque<T> elements;
+    typename Storage::template type<T> elements;
 
 public:
+    Queue() = default;
+
+    explicit Queue(std::pmr::memory_resource* resource) : elements(resource) {}
+
     void push(const T& item) {
-        elements.push_back(item);
+        elements.emplace_back(item);
+    }
+
+    void push(T&& item) {
+        elements.emplace_back(std::move(item));
+    }
+
+    // Конструирует элемент прямо в очереди
+    template <typename... Args>
+    T& emplace(Args&&... args) {
+        return elements.emplace_back(std::forward<Args>(args)...);
     }
 
-    void pop() {
+    // Забирает первый элемент перемещением; на пустой очереди возвращает std::nullopt
+    std::optional<T> pop() {
         if (elements.empty()) {
-            throw std::out_of_range("Queue is empty, cannot pop");
+            return std::nullopt;
         }
+        std::optional<T> item(std::move(elements.front()));
         elements.pop_front();
+        return item;
     }
 
     T& front() {
-        if (elements.empty()) {
-            throw std::out_of_range("Queue is empty, no front element");
+        if constexpr (Access::checked) {
+            if (elements.empty()) {
+                throw std::out_of_range("Queue is empty, no front element");
+            }
         }
         return elements.front();
     }
@@ -31,13 +183,666 @@ public:
     }
 };
 
-int main() {
-    // Тестирование исключения для pop() на пустой очереди
+constexpr std::size_t cacheLineSize = 64;
+
+// Ёмкость кольца округляется вверх до степени двойки, чтобы индекс брался маской
+inline std::size_t ringCapacity(std::size_t requested) {
+    return std::bit_ceil(std::max<std::size_t>(requested, 2));
+}
+
+// Идентификатор запланированного события; поколение отличает его от события,
+// занявшего тот же узел после отмены или срабатывания
+struct TimerId {
+    std::uint32_t index;
+    std::uint32_t generation;
+};
+
+// Очередь событий по тикам на хешированном колесе таймеров. Событие со сроком due
+// лежит в ячейке due % размер колеса в двусвязном списке узлов, поэтому schedule и
+// cancel - O(1). drainUntil проходит ячейки тиков по порядку и переносит наступившие
+// события в Queue<T>; события дальше одного оборота колеса остаются в ячейке до своего круга.
+template <typename T>
+class ScheduledQueue {
+private:
+    static constexpr std::uint32_t none = UINT32_MAX;
+
+    struct Node {
+        std::optional<T> item;
+        std::uint64_t due = 0;
+        std::uint32_t prev = none;
+        std::uint32_t next = none;
+        std::uint32_t generation = 0;
+    };
+
+    struct Bucket {
+        std::uint32_t head = none;
+        std::uint32_t tail = none;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> freeNodes;
+    std::vector<Bucket> wheel;
+    std::size_t mask;
+    std::uint64_t now = 0;
+    std::size_t pending = 0;
+
+    Bucket& bucketFor(std::uint64_t tick) {
+        return wheel[tick & mask];
+    }
+
+    void unlink(std::uint32_t index) {
+        Node& node = nodes[index];
+        Bucket& bucket = bucketFor(node.due);
+        (node.prev == none ? bucket.head : nodes[node.prev].next) = node.next;
+        (node.next == none ? bucket.tail : nodes[node.next].prev) = node.prev;
+    }
+
+    void release(std::uint32_t index) {
+        Node& node = nodes[index];
+        node.item.reset();
+        ++node.generation;
+        freeNodes.push_back(index);
+        --pending;
+    }
+
+public:
+    explicit ScheduledQueue(std::size_t wheelSize = 256)
+        : wheel(ringCapacity(wheelSize)), mask(wheel.size() - 1) {}
+
+    std::uint64_t currentTick() const {
+        return now;
+    }
+
+    std::size_t size() const {
+        return pending;
+    }
+
+    bool empty() const {
+        return pending == 0;
+    }
+
+    // Планирует событие на тик due; прошедшие тики сдвигаются на ближайший следующий.
+    // События одного тика выдаются в порядке планирования.
+    TimerId schedule(std::uint64_t due, T item) {
+        due = std::max(due, now + 1);
+        std::uint32_t index;
+        if (freeNodes.empty()) {
+            index = static_cast<std::uint32_t>(nodes.size());
+            nodes.emplace_back();
+        } else {
+            index = freeNodes.back();
+            freeNodes.pop_back();
+        }
+        Node& node = nodes[index];
+        node.item.emplace(std::move(item));
+        node.due = due;
+        Bucket& bucket = bucketFor(due);
+        node.prev = bucket.tail;
+        node.next = none;
+        (bucket.tail == none ? bucket.head : nodes[bucket.tail].next) = index;
+        bucket.tail = index;
+        ++pending;
+        return TimerId{index, node.generation};
+    }
+
+    TimerId scheduleAfter(std::uint64_t delay, T item) {
+        return schedule(now + delay, std::move(item));
+    }
+
+    // Возвращает false, если событие уже сработало или было отменено
+    bool cancel(TimerId id) {
+        if (id.index >= nodes.size() || nodes[id.index].generation != id.generation) {
+            return false;
+        }
+        unlink(id.index);
+        release(id.index);
+        return true;
+    }
+
+    // Переносит в out все события со сроком не позже tick в порядке срабатывания
+    // и продвигает текущий тик; возвращает число перенесённых событий
+    template <typename Access, typename Storage>
+    std::size_t drainUntil(std::uint64_t tick, Queue<T, Access, Storage>& out) {
+        std::size_t drained = 0;
+        while (now < tick) {
+            if (pending == 0) {
+                now = tick;
+                break;
+            }
+            ++now;
+            Bucket& bucket = bucketFor(now);
+            for (std::uint32_t index = bucket.head; index != none;) {
+                const std::uint32_t next = nodes[index].next;
+                if (nodes[index].due == now) {
+                    unlink(index);
+                    out.push(std::move(*nodes[index].item));
+                    release(index);
+                    ++drained;
+                }
+                index = next;
+            }
+        }
+        return drained;
+    }
+};
+
+// Ограниченная lock-free очередь для одного производителя и одного потребителя.
+// Производитель и потребитель держат свои индексы на отдельных кэш-линиях и
+// кэшируют чужой индекс, обращаясь к нему только когда кольцо кажется полным/пустым.
+template <typename T>
+class SpscQueue {
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        T* get() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    std::size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    // Линия потребителя
+    alignas(cacheLineSize) std::atomic<std::size_t> head{0};
+    std::size_t cachedTail = 0;
+
+    // Линия производителя
+    alignas(cacheLineSize) std::atomic<std::size_t> tail{0};
+    std::size_t cachedHead = 0;
+
+    template <typename U>
+    bool emplaceBack(U&& item) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > mask) {
+                return false;
+            }
+        }
+        new (slots[t & mask].storage) T(std::forward<U>(item));
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Передаёт первый элемент в sink и освобождает слот
+    template <typename Sink>
+    bool consume(Sink&& sink) {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return false;
+            }
+        }
+        T* item = slots[h & mask].get();
+        sink(*item);
+        item->~T();
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+public:
+    explicit SpscQueue(std::size_t capacity = 1024)
+        : mask(ringCapacity(capacity) - 1), slots(new Slot[mask + 1]) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    ~SpscQueue() {
+        while (consume([](T&) {})) {
+        }
+    }
+
+    std::size_t capacity() const {
+        return mask + 1;
+    }
+
+    bool try_push(const T& item) {
+        return emplaceBack(item);
+    }
+
+    bool try_push(T&& item) {
+        return emplaceBack(std::move(item));
+    }
+
+    bool try_pop(T& out) {
+        return consume([&](T& item) { out = std::move(item); });
+    }
+
+    // Кладёт до n элементов, публикуя их одной записью хвоста
+    std::size_t push_n(const T* items, std::size_t n) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t space = mask + 1 - (t - cachedHead);
+        if (space < n) {
+            cachedHead = head.load(std::memory_order_acquire);
+            space = mask + 1 - (t - cachedHead);
+        }
+        const std::size_t count = std::min(n, space);
+        for (std::size_t i = 0; i < count; ++i) {
+            new (slots[(t + i) & mask].storage) T(items[i]);
+        }
+        if (count > 0) {
+            tail.store(t + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // Забирает до n элементов, освобождая слоты одной записью головы
+    std::size_t pop_n(T* out, std::size_t n) {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        std::size_t ready = cachedTail - h;
+        if (ready < n) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            ready = cachedTail - h;
+        }
+        const std::size_t count = std::min(n, ready);
+        for (std::size_t i = 0; i < count; ++i) {
+            T* item = slots[(h + i) & mask].get();
+            out[i] = std::move(*item);
+            item->~T();
+        }
+        if (count > 0) {
+            head.store(h + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    void push(const T& item) {
+        if (!try_push(item)) {
+            throw std::overflow_error("Queue is full, cannot push");
+        }
+    }
+
+    void push(T&& item) {
+        if (!try_push(std::move(item))) {
+            throw std::overflow_error("Queue is full, cannot push");
+        }
+    }
+
+    std::optional<T> pop() {
+        std::optional<T> result;
+        consume([&](T& item) { result.emplace(std::move(item)); });
+        return result;
+    }
+
+    // Вызывается только потребителем
+    T& front() {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            throw std::out_of_range("Queue is empty, no front element");
+        }
+        return *slots[h & mask].get();
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+// Ограниченная lock-free очередь для многих производителей и потребителей (схема Вьюкова).
+// У каждой ячейки свой счётчик последовательности: ячейка свободна для записи на позиции pos,
+// когда sequence == pos, и готова к чтению, когда sequence == pos + 1.
+// Ячейки выровнены по кэш-линии, чтобы соседние push/pop не делили одну линию.
+template <typename T>
+class MpmcQueue {
+private:
+    struct alignas(cacheLineSize) Cell {
+        std::atomic<std::size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+        T* get() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    std::size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(cacheLineSize) std::atomic<std::size_t> enqueuePos{0};
+    alignas(cacheLineSize) std::atomic<std::size_t> dequeuePos{0};
+
+    template <typename U>
+    bool emplaceBack(U&& item) {
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->storage) T(std::forward<U>(item));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Sink>
+    bool consume(Sink&& sink) {
+        std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        T* item = cell->get();
+        sink(*item);
+        item->~T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+public:
+    explicit MpmcQueue(std::size_t capacity = 1024)
+        : mask(ringCapacity(capacity) - 1), cells(new Cell[mask + 1]) {
+        for (std::size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    ~MpmcQueue() {
+        while (consume([](T&) {})) {
+        }
+    }
+
+    std::size_t capacity() const {
+        return mask + 1;
+    }
+
+    bool try_push(const T& item) {
+        return emplaceBack(item);
+    }
+
+    bool try_push(T&& item) {
+        return emplaceBack(std::move(item));
+    }
+
+    bool try_pop(T& out) {
+        return consume([&](T& item) { out = std::move(item); });
+    }
+
+    // Ячейки захватываются по одной: общий хвост между производителями
+    // нельзя сдвинуть на n сразу, не зная, что все n ячеек свободны
+    std::size_t push_n(const T* items, std::size_t n) {
+        std::size_t count = 0;
+        while (count < n && try_push(items[count])) {
+            ++count;
+        }
+        return count;
+    }
+
+    std::size_t pop_n(T* out, std::size_t n) {
+        std::size_t count = 0;
+        while (count < n && try_pop(out[count])) {
+            ++count;
+        }
+        return count;
+    }
+
+    void push(const T& item) {
+        if (!try_push(item)) {
+            throw std::overflow_error("Queue is full, cannot push");
+        }
+    }
+
+    void push(T&& item) {
+        if (!try_push(std::move(item))) {
+            throw std::overflow_error("Queue is full, cannot push");
+        }
+    }
+
+    std::optional<T> pop() {
+        std::optional<T> result;
+        consume([&](T& item) { result.emplace(std::move(item)); });
+        return result;
+    }
+
+    // Ссылка остаётся действительной, только пока элемент не забрал другой потребитель,
+    // поэтому front() имеет смысл при единственном потребителе
+    T& front() {
+        const std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = cells[pos & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+            throw std::out_of_range("Queue is empty, no front element");
+        }
+        return *cell.get();
+    }
+
+    bool empty() const {
+        const std::size_t pos = dequeuePos.load(std::memory_order_acquire);
+        return cells[pos & mask].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+};
+
+// Queue<T> под мьютексом с тем же ограничением ёмкости - точка отсчёта для бенчмарка
+template <typename T>
+class LockedQueue {
+private:
+    Queue<T, UncheckedAccess> queue;
+    std::size_t count = 0;
+    std::size_t limit;
+    std::mutex mutex;
+
+public:
+    explicit LockedQueue(std::size_t capacity = 1024) : limit(capacity) {}
+
+    bool try_push(const T& item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == limit) {
+            return false;
+        }
+        queue.push(item);
+        ++count;
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::optional<T> item = queue.pop();
+        if (!item) {
+            return false;
+        }
+        out = std::move(*item);
+        --count;
+        return true;
+    }
+
+    std::size_t push_n(const T* items, std::size_t n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::size_t pushed = std::min(n, limit - count);
+        for (std::size_t i = 0; i < pushed; ++i) {
+            queue.push(items[i]);
+        }
+        count += pushed;
+        return pushed;
+    }
+
+    std::size_t pop_n(T* out, std::size_t n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::size_t popped = 0;
+        while (popped < n) {
+            std::optional<T> item = queue.pop();
+            if (!item) {
+                break;
+            }
+            out[popped++] = std::move(*item);
+        }
+        count -= popped;
+        return popped;
+    }
+};
+
+std::uint64_t benchClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct BenchResult {
+    double itemsPerSec;
+    std::uint64_t medianLatencyNs;
+    std::uint64_t p99LatencyNs;
+};
+
+// Производители кладут метки времени, потребители считают задержку доставки.
+// batch > 1 включает push_n/pop_n.
+template <typename Q>
+BenchResult runQueueBench(int producers, int consumers, std::size_t itemsPerProducer, std::size_t batch) {
+    Q queue(1024);
+    const std::size_t total = itemsPerProducer * producers;
+    std::atomic<std::size_t> consumed{0};
+    std::vector<std::vector<std::uint64_t>> latencies(consumers);
+    std::vector<std::thread> threads;
+
+    const std::uint64_t start = benchClockNs();
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&] {
+            std::vector<std::uint64_t> items(batch);
+            for (std::size_t sent = 0; sent < itemsPerProducer;) {
+                const std::size_t n = std::min(batch, itemsPerProducer - sent);
+                const std::uint64_t now = benchClockNs();
+                std::fill_n(items.begin(), n, now);
+                std::size_t done = 0;
+                while (done < n) {
+                    const std::size_t k = batch == 1 ? queue.try_push(items[0]) : queue.push_n(items.data() + done, n - done);
+                    if (k == 0) {
+                        std::this_thread::yield();
+                    }
+                    done += k;
+                }
+                sent += n;
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c] {
+            std::vector<std::uint64_t> items(batch);
+            auto& samples = latencies[c];
+            std::size_t seen = 0;
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                const std::size_t k = batch == 1 ? queue.try_pop(items[0]) : queue.pop_n(items.data(), batch);
+                if (k == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                const std::uint64_t now = benchClockNs();
+                for (std::size_t i = 0; i < k; ++i, ++seen) {
+                    if (seen % 64 == 0) {
+                        samples.push_back(now - items[i]);
+                    }
+                }
+                consumed.fetch_add(k, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double seconds = (benchClockNs() - start) / 1e9;
+
+    std::vector<std::uint64_t> all;
+    for (auto& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+    BenchResult result{total / seconds, 0, 0};
+    if (!all.empty()) {
+        result.medianLatencyNs = all[all.size() / 2];
+        result.p99LatencyNs = all[all.size() * 99 / 100];
+    }
+    return result;
+}
+
+void benchmarkQueues() {
+    const std::size_t items = 2'000'000;
+    auto report = [](const char* name, const BenchResult& r) {
+        std::cout << name << ": " << static_cast<std::uint64_t>(r.itemsPerSec / 1000) << " тыс. эл/с, задержка медиана "
+                  << r.medianLatencyNs << " нс, p99 " << r.p99LatencyNs << " нс" << std::endl;
+    };
+    std::cout << "1 производитель / 1 потребитель, " << items << " элементов" << std::endl;
+    report("  deque + mutex       ", runQueueBench<LockedQueue<std::uint64_t>>(1, 1, items, 1));
+    report("  SpscQueue           ", runQueueBench<SpscQueue<std::uint64_t>>(1, 1, items, 1));
+    report("  MpmcQueue           ", runQueueBench<MpmcQueue<std::uint64_t>>(1, 1, items, 1));
+    report("  deque + mutex, по 64", runQueueBench<LockedQueue<std::uint64_t>>(1, 1, items, 64));
+    report("  SpscQueue, по 64    ", runQueueBench<SpscQueue<std::uint64_t>>(1, 1, items, 64));
+    std::cout << "4 производителя / 4 потребителя" << std::endl;
+    report("  deque + mutex       ", runQueueBench<LockedQueue<std::uint64_t>>(4, 4, items / 4, 1));
+    report("  MpmcQueue           ", runQueueBench<MpmcQueue<std::uint64_t>>(4, 4, items / 4, 1));
+}
+
+struct TickEvent {
+    int source;
+    int target;
+    double amount;
+};
+
+// Каждый тик создаёт короткую очередь событий (до 32 штук), заполняет её и выбирает.
+// makeQueue получает арену тика; после тика арена сбрасывается целиком.
+template <typename Q>
+double runTickBench(std::size_t ticks, bool useArena) {
+    alignas(std::max_align_t) static unsigned char arenaBuffer[64 * 1024];
+    std::pmr::monotonic_buffer_resource arena(arenaBuffer, sizeof(arenaBuffer));
+    double checksum = 0;
+    const std::uint64_t start = benchClockNs();
+    for (std::size_t tick = 0; tick < ticks; ++tick) {
+        {
+            Q queue(useArena ? static_cast<std::pmr::memory_resource*>(&arena) : std::pmr::get_default_resource());
+            const int events = 1 + static_cast<int>(tick * 7 % 31);
+            for (int i = 0; i < events; ++i) {
+                queue.emplace(TickEvent{i, events - i, i * 1.5});
+            }
+            while (std::optional<TickEvent> event = queue.pop()) {
+                checksum += event->amount;
+            }
+        }
+        if (useArena) {
+            arena.release();
+        }
+    }
+    const double nsPerTick = static_cast<double>(benchClockNs() - start) / ticks;
+    if (checksum < 0) {
+        std::cout << checksum;
+    }
+    return nsPerTick;
+}
+
+void benchmarkStorage() {
+    const std::size_t ticks = 1'000'000;
+    auto report = [](const char* name, double nsPerTick) {
+        std::cout << name << ": " << static_cast<std::uint64_t>(nsPerTick) << " нс/тик" << std::endl;
+    };
+    std::cout << "Очередь событий на тик, до 32 элементов" << std::endl;
+    report("  std::deque          ", runTickBench<Queue<TickEvent, UncheckedAccess, DequeStorage>>(ticks, false));
+    report("  std::deque + арена  ", runTickBench<Queue<TickEvent, UncheckedAccess, DequeStorage>>(ticks, true));
+    report("  кольцо              ", runTickBench<Queue<TickEvent, UncheckedAccess, RingStorage>>(ticks, false));
+    report("  кольцо + арена      ", runTickBench<Queue<TickEvent, UncheckedAccess, RingStorage>>(ticks, true));
+    report("  встроенный буфер 32 ", runTickBench<Queue<TickEvent, UncheckedAccess, SmallStorage<32>>>(ticks, false));
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        benchmarkQueues();
+        benchmarkStorage();
+        return 0;
+    }
+
+    // pop() на пустой очереди не бросает исключение, а возвращает пустой optional
     Queue<int> intQueue;
-    try {
-        intQueue.pop(); // Попытка удалить из пустой очереди
-    } catch (const std::out_of_range& e) {
-        std::cerr << "Ошибка: " << e.what() << std::endl;
+    if (!intQueue.pop()) {
+        std::cout << "pop() на пустой очереди вернул пустой optional" << std::endl;
     }
 
     // Тестирование исключения для front() на пустой очереди
@@ -58,5 +863,75 @@ int main() {
         std::cerr << "Ошибка: " << e.what() << std::endl;
     }
 
+    // Строки перемещаются и конструируются на месте, цикл выборки обходится без исключений
+    Queue<std::string, UncheckedAccess> stringQueue;
+    std::string greeting = "Привет";
+    stringQueue.push(std::move(greeting));
+    stringQueue.emplace(3, '!');
+    while (std::optional<std::string> item = stringQueue.pop()) {
+        std::cout << "Строка: " << *item << std::endl;
+    }
+
+    // Очередь на один тик: первые 8 событий во встроенном буфере, остальные - в арене,
+    // которая освобождается целиком без обхода элементов
+    std::pmr::monotonic_buffer_resource tickArena;
+    {
+        Queue<std::string, UncheckedAccess, SmallStorage<8>> tickQueue(&tickArena);
+        for (int i = 0; i < 12; ++i) {
+            tickQueue.emplace("событие " + std::to_string(i));
+        }
+        std::size_t drained = 0;
+        while (tickQueue.pop()) {
+            ++drained;
+        }
+        std::cout << "Событий за тик: " << drained << std::endl;
+    }
+    tickArena.release();
+
+    // События боя по тикам: отменённый удар не срабатывает, всё наступившее
+    // к тику забирается одним вызовом
+    ScheduledQueue<std::string> timeline;
+    timeline.schedule(1, "Герой атакует");
+    timeline.schedule(2, "Гоблин атакует");
+    TimerId heal = timeline.schedule(3, "Лечение героя");
+    timeline.scheduleAfter(300, "Кулдаун способности закончился");
+    timeline.cancel(heal);
+    Queue<std::string, UncheckedAccess> dueEvents;
+    for (std::uint64_t tick : {2, 3, 300}) {
+        timeline.drainUntil(tick, dueEvents);
+        while (std::optional<std::string> event = dueEvents.pop()) {
+            std::cout << "Тик " << tick << ": " << *event << std::endl;
+        }
+    }
+
+    // Передача элементов между потоками через ограниченную очередь
+    SpscQueue<int> channel(4);
+    try {
+        for (int i = 1; i <= 5; ++i) {
+            channel.push(i); // Пятый элемент не помещается
+        }
+    } catch (const std::overflow_error& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+    }
+    std::thread producer([&] {
+        for (int i = 5; i <= 8; ++i) {
+            while (!channel.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    int sum = 0;
+    for (int received = 0; received < 8;) {
+        int value;
+        if (channel.try_pop(value)) {
+            sum += value;
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    std::cout << "Сумма элементов из другого потока: " << sum << std::endl;
+
     return 0;
 }
\ No newline at end of file
@@ -3,103 +3,813 @@
 #include <mutex>
 #include <chrono>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <functional>
+#include <random>
+#include <atomic>
+#include <barrier>
+#include <coroutine>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
+// Таблица имён участников боя: одно имя - один номер на всё время работы программы.
+// Участники создаются в любых потоках, поэтому таблица под мьютексом; deque не перемещает
+// строки при росте, и ссылка из combatName остаётся действительной после разблокировки
+struct CombatNameTable {
+    std::mutex mtx;
+    std::deque<std::string> names;
+    std::unordered_map<std::string, std::uint32_t> ids;
+};
+
+CombatNameTable& combatNames() {
+    static CombatNameTable table;
+    return table;
+}
+
+std::uint32_t combatNameId(const std::string& name) {
+    CombatNameTable& table = combatNames();
+    std::lock_guard<std::mutex> lock(table.mtx);
+    auto [it, inserted] = table.ids.try_emplace(name, static_cast<std::uint32_t>(table.names.size()));
+    if (inserted) table.names.push_back(name);
+    return it->second;
+}
+
+const std::string& combatName(std::uint32_t id) {
+    CombatNameTable& table = combatNames();
+    std::lock_guard<std::mutex> lock(table.mtx);
+    return table.names[id];
+}
+
+// Здоровье меняется атомарно без блокировок; мьютекс нужен только составным
+// обновлениям нескольких участников (см. OrderedLock)
 class Character {
 private:
     std::string name;
-    int health;
+    std::uint32_t nameId;
+    std::atomic<int> health;
     int attack;
     int defense;
     std::mutex mtx;
 
 public:
     Character(const std::string& n, int h, int a, int d)
-        : name(n), health(h), attack(a), defense(d) {}
+        : name(n), nameId(combatNameId(n)), health(h), attack(a), defense(d) {}
 
     bool isAlive() const {
-        return health > 0;
+        return health.load(std::memory_order_acquire) > 0;
     }
 
-    void takeDamage(int damage) {
-        std::lock_guard<std::mutex> lock(mtx);
-        health -= damage;
-        if (health < 0) health = 0;
+    // Снимает здоровье, не опуская его ниже нуля; возвращает фактически нанесённый урон
+    int applyDamage(int damage) {
+        int current = health.load(std::memory_order_relaxed);
+        int next;
+        do {
+            next = std::max(current - damage, 0);
+        } while (current != next &&
+                 !health.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_relaxed));
+        return current - next;
+    }
+
+    // Восстанавливает здоровье живому участнику; возвращает, сколько восстановлено
+    int heal(int amount) {
+        int current = health.load(std::memory_order_relaxed);
+        while (current > 0) {
+            if (health.compare_exchange_weak(current, current + amount, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return amount;
+            }
+        }
+        return 0;
     }
 
     int getAttack() const { return attack; }
     int getDefense() const { return defense; }
-    std::string getName() const { return name; }
-    int getHealth() const { return health; }
+    const std::string& getName() const { return name; }
+    std::uint32_t getNameId() const { return nameId; }
+    int getHealth() const { return health.load(std::memory_order_acquire); }
+    std::mutex& getMutex() { return mtx; }
 };
 
 class Monster {
 private:
     std::string name;
-    int health;
+    std::uint32_t nameId;
+    std::atomic<int> health;
     int attack;
     int defense;
     std::mutex mtx;
 
 public:
     Monster(const std::string& n, int h, int a, int d)
-        : name(n), health(h), attack(a), defense(d) {}
+        : name(n), nameId(combatNameId(n)), health(h), attack(a), defense(d) {}
 
     bool isAlive() const {
-        return health > 0;
+        return health.load(std::memory_order_acquire) > 0;
     }
 
-    void takeDamage(int damage) {
-        std::lock_guard<std::mutex> lock(mtx);
-        health -= damage;
-        if (health < 0) health = 0;
+    // Снимает здоровье, не опуская его ниже нуля; возвращает фактически нанесённый урон
+    int applyDamage(int damage) {
+        int current = health.load(std::memory_order_relaxed);
+        int next;
+        do {
+            next = std::max(current - damage, 0);
+        } while (current != next &&
+                 !health.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_relaxed));
+        return current - next;
+    }
+
+    // Восстанавливает здоровье живому участнику; возвращает, сколько восстановлено
+    int heal(int amount) {
+        int current = health.load(std::memory_order_relaxed);
+        while (current > 0) {
+            if (health.compare_exchange_weak(current, current + amount, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return amount;
+            }
+        }
+        return 0;
     }
 
     int getAttack() const { return attack; }
     int getDefense() const { return defense; }
-    std::string getName() const { return name; }
-    int getHealth() const { return health; }
+    const std::string& getName() const { return name; }
+    std::uint32_t getNameId() const { return nameId; }
+    int getHealth() const { return health.load(std::memory_order_acquire); }
+    std::mutex& getMutex() { return mtx; }
 };
 
-void battle(Character& hero, Monster& monster) {
-    while (hero.isAlive() && monster.isAlive()) {
+// Захватывает мьютексы нескольких участников всегда в порядке их адресов, поэтому
+// два составных обновления с одними и теми же участниками не могут взаимно заблокироваться.
+// Один и тот же участник может быть передан несколько раз.
+template <std::size_t N>
+class OrderedLock {
+private:
+    std::array<std::mutex*, N> mutexes;
+    std::size_t count;
+
+public:
+    template <typename... Entities>
+    explicit OrderedLock(Entities&... entities) : mutexes{&entities.getMutex()...} {
+        std::sort(mutexes.begin(), mutexes.end(), std::less<std::mutex*>());
+        count = std::unique(mutexes.begin(), mutexes.end()) - mutexes.begin();
+        for (std::size_t i = 0; i < count; ++i) {
+            mutexes[i]->lock();
+        }
+    }
+
+    OrderedLock(const OrderedLock&) = delete;
+    OrderedLock& operator=(const OrderedLock&) = delete;
+
+    ~OrderedLock() {
+        for (std::size_t i = count; i > 0; --i) {
+            mutexes[i - 1]->unlock();
+        }
+    }
+};
+
+template <typename... Entities>
+OrderedLock(Entities&...) -> OrderedLock<sizeof...(Entities)>;
+
+// Вампирский удар: урон цели и лечение атакующего на ту же величину как одно обновление.
+// Возвращает нанесённый урон; healed - сколько восстановил атакующий (0, если он уже пал).
+template <typename Attacker, typename Target>
+int drainLife(Attacker& attacker, Target& target, int damage, int& healed) {
+    OrderedLock lock(attacker, target);
+    const int dealt = target.applyDamage(damage);
+    healed = attacker.heal(dealt);
+    return dealt;
+}
+
+// События боя. Приёмник передаётся каждому бою явно: задачи исполнителя переходят
+// между потоками, поэтому приёмник, привязанный к потоку, здесь не подходит
+enum class CombatEventType : std::uint8_t {
+    ATTACK,
+    NO_EFFECT,
+    DEFEAT
+};
+
+// Участники записываются номерами имён из combatNameId, поэтому событие можно
+// хранить в буфере дольше, чем живут сами участники; value - урон
+struct CombatEvent {
+    CombatEventType type;
+    std::uint32_t source;
+    std::uint32_t target;
+    std::int32_t value;
+};
+
+class CombatSink {
+public:
+    virtual ~CombatSink() = default;
+    virtual void emit(const CombatEvent& event) = 0;
+    virtual void flush() {}
+};
+
+// Бои без вывода: события отбрасываются, форматирования нет совсем
+class NullCombatSink : public CombatSink {
+public:
+    void emit(const CombatEvent&) override {}
+};
+
+// Текст для консоли: события копятся в буфере и форматируются пачкой при flush()
+// или при заполнении буфера, одной записью в поток. Бои с общим приёмником могут
+// выполняться в разных потоках, поэтому буфер под мьютексом
+class TextCombatSink : public CombatSink {
+private:
+    std::ostream& out;
+    std::mutex mtx;
+    std::vector<CombatEvent> pending;
+    std::size_t capacity;
+
+    static void render(std::string& text, const CombatEvent& e) {
+        const std::string& source = combatName(e.source);
+        const std::string& target = combatName(e.target);
+        switch (e.type) {
+            case CombatEventType::ATTACK:
+                text += source + " attacks " + target + " for " + std::to_string(e.value) + " damage!\n";
+                break;
+            case CombatEventType::NO_EFFECT: text += source + " attacks " + target + ", but it has no effect!\n"; break;
+            case CombatEventType::DEFEAT: text += target + " has been defeated!\n"; break;
+        }
+    }
+
+    void flushLocked() {
+        if (pending.empty()) return;
+        std::string text;
+        for (const auto& event : pending) render(text, event);
+        pending.clear();
+        out << text << std::flush;
+    }
+
+public:
+    explicit TextCombatSink(std::ostream& out, std::size_t capacity = 256) : out(out), capacity(capacity) {
+        pending.reserve(capacity);
+    }
+
+    ~TextCombatSink() override { flush(); }
+
+    void emit(const CombatEvent& event) override {
+        std::lock_guard<std::mutex> lock(mtx);
+        pending.push_back(event);
+        if (pending.size() >= capacity) flushLocked();
+    }
+
+    void flush() override {
+        std::lock_guard<std::mutex> lock(mtx);
+        flushLocked();
+    }
+};
+
+// Приёмник по умолчанию для боёв без вывода (замеры)
+CombatSink& nullCombatSink() {
+    static NullCombatSink sink;
+    return sink;
+}
+
+// Один удар: урон - разница атаки и защиты, если она положительна
+template <typename Attacker, typename Target>
+void strike(Attacker& attacker, Target& target, CombatSink& sink) {
+    const int damage = attacker.getAttack() - target.getDefense();
+    if (damage > 0) {
+        target.applyDamage(damage);
+        sink.emit({CombatEventType::ATTACK, attacker.getNameId(), target.getNameId(), damage});
+    } else {
+        sink.emit({CombatEventType::NO_EFFECT, attacker.getNameId(), target.getNameId(), 0});
+    }
+    if (!target.isAlive()) sink.emit({CombatEventType::DEFEAT, attacker.getNameId(), target.getNameId(), 0});
+}
+
+// Задача, которую исполнитель может прервать и продолжить позже.
+// resume() выполняет один шаг и возвращает, через сколько тиков продолжить,
+// или отрицательное число, если задача завершена.
+class Task {
+public:
+    virtual ~Task() = default;
+    virtual int resume() = 0;
+};
+
+// Бой как возобновляемая задача: один вызов resume() - один раунд
+class Battle : public Task {
+private:
+    Character& hero;
+    Monster& monster;
+    CombatSink& sink;
+    int rounds = 0;
+
+    int round() {
         // Персонаж атакует монстра
-        {
-            std::lock_guard<std::mutex> lock1(hero.mtx);
-            std::lock_guard<std::mutex> lock2(monster.mtx);
-            int damage = hero.getAttack() - monster.getDefense();
-            if (damage > 0) {
-                monster.takeDamage(damage);
-                std::cout << hero.getName() << " attacks " << monster.getName()
-                          << " for " << damage << " damage!" << std::endl;
+        strike(hero, monster, sink);
+        if (!monster.isAlive()) return -1;
+
+        // Монстр атакует персонажа
+        strike(monster, hero, sink);
+        if (!hero.isAlive()) return -1;
+        return 1; // Следующий раунд - на следующем тике
+    }
+
+public:
+    Battle(Character& hero, Monster& monster, CombatSink& sink = nullCombatSink())
+        : hero(hero), monster(monster), sink(sink) {}
+
+    // Текст раунда выводится одной записью в его конце
+    int resume() override {
+        ++rounds;
+        const int next = round();
+        sink.flush();
+        return next;
+    }
+
+    int getRounds() const { return rounds; }
+};
+
+// Исполнитель задач на фиксированном пуле потоков.
+// У каждого потока своя очередь готовых задач: владелец берёт задачи с конца,
+// свободные потоки воруют с начала чужих очередей. Время идёт тиками; задача,
+// уступившая управление, кладётся в колесо своего потока на тик срабатывания.
+// Тик заканчивается, когда выполнены все задачи, назначенные на него.
+class BattleExecutor {
+private:
+    static constexpr std::size_t wheelSize = 64;
+
+    // Задача в колесе с абсолютным тиком срабатывания: задержка длиннее колеса
+    // проходит по ячейке несколько оборотов и срабатывает только на своём тике
+    struct Timer {
+        Task* task;
+        std::uint64_t due;
+    };
+
+    struct alignas(64) Worker {
+        std::mutex mtx;
+        std::deque<Task*> ready;
+        std::vector<std::vector<Timer>> wheel{wheelSize};
+    };
+
+    struct TickAdvance {
+        BattleExecutor* owner;
+        void operator()() noexcept { owner->advanceTick(); }
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::chrono::steady_clock::duration tickDuration;
+    std::chrono::steady_clock::time_point started;
+    std::uint64_t tick = 0;
+    bool stopped = false;
+    std::atomic<std::size_t> live{0};
+    std::atomic<std::size_t> remaining{0};
+
+    // Выполняется одним потоком, пока остальные ждут на барьере
+    void advanceTick() {
+        ++tick;
+        stopped = live.load(std::memory_order_relaxed) == 0;
+        if (!stopped && tickDuration.count() > 0) {
+            std::this_thread::sleep_until(started + tick * tickDuration);
+        }
+        std::size_t due = 0;
+        for (auto& worker : workers) {
+            for (const Timer& timer : worker->wheel[tick % wheelSize]) {
+                due += timer.due == tick;
             }
         }
+        remaining.store(due, std::memory_order_relaxed);
+    }
 
-        if (!monster.isAlive()) break;
+    bool popLocal(Worker& self, Task*& task) {
+        std::lock_guard<std::mutex> lock(self.mtx);
+        if (self.ready.empty()) {
+            return false;
+        }
+        task = self.ready.back();
+        self.ready.pop_back();
+        return true;
+    }
 
-        // Монстр атакует персонажа
-        {
-            std::lock_guard<std::mutex> lock1(monster.mtx);
-            std::lock_guard<std::mutex> lock2(hero.mtx);
-            int damage = monster.getAttack() - hero.getDefense();
-            if (damage > 0) {
-                hero.takeDamage(damage);
-                std::cout << monster.getName() << " attacks " << hero.getName()
-                          << " for " << damage << " damage!" << std::endl;
+    bool steal(std::size_t self, Task*& task) {
+        for (std::size_t i = 1; i < workers.size(); ++i) {
+            Worker& victim = *workers[(self + i) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mtx);
+            if (!victim.ready.empty()) {
+                task = victim.ready.front();
+                victim.ready.pop_front();
+                return true;
             }
         }
+        return false;
+    }
 
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    void startTick(Worker& self) {
+        auto& slot = self.wheel[tick % wheelSize];
+        std::lock_guard<std::mutex> lock(self.mtx);
+        std::size_t kept = 0;
+        for (const Timer& timer : slot) {
+            if (timer.due == tick) {
+                self.ready.push_back(timer.task);
+            } else {
+                slot[kept++] = timer;
+            }
+        }
+        slot.resize(kept);
     }
+
+    void workerLoop(std::size_t index, std::barrier<TickAdvance>& tickBarrier) {
+        Worker& self = *workers[index];
+        startTick(self);
+        for (;;) {
+            Task* task = nullptr;
+            if (popLocal(self, task) || steal(index, task)) {
+                const int delay = task->resume();
+                if (delay < 0) {
+                    live.fetch_sub(1, std::memory_order_relaxed);
+                } else {
+                    // Текущий тик уже идёт, поэтому задержка 0 означает следующий
+                    const std::uint64_t due = tick + static_cast<std::uint64_t>(std::max(delay, 1));
+                    self.wheel[due % wheelSize].push_back({task, due});
+                }
+                remaining.fetch_sub(1, std::memory_order_acq_rel);
+                continue;
+            }
+            if (remaining.load(std::memory_order_acquire) > 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            tickBarrier.arrive_and_wait();
+            if (stopped) {
+                return;
+            }
+            startTick(self);
+        }
+    }
+
+public:
+    explicit BattleExecutor(std::size_t threads = std::thread::hardware_concurrency(),
+                            std::chrono::steady_clock::duration tickDuration = {})
+        : tickDuration(tickDuration) {
+        for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+    }
+
+    std::size_t threadCount() const {
+        return workers.size();
+    }
+
+    // Выполняет задачи до завершения всех; возвращает число прошедших тиков
+    std::uint64_t run(const std::vector<Task*>& tasks) {
+        tick = 0;
+        stopped = tasks.empty();
+        live.store(tasks.size());
+        remaining.store(tasks.size());
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+            workers[i % workers.size()]->wheel[0].push_back({tasks[i], 0});
+        }
+        started = std::chrono::steady_clock::now();
+
+        std::barrier<TickAdvance> tickBarrier(static_cast<std::ptrdiff_t>(workers.size()), TickAdvance{this});
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < workers.size(); ++i) {
+            threads.emplace_back(&BattleExecutor::workerLoop, this, i, std::ref(tickBarrier));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return tick;
+    }
+};
+
+// Сопрограмма боя. Запускается лениво планировщиком и после завершения остаётся
+// приостановленной, пока её не уничтожит владелец. Кадры сопрограмм считаются,
+// чтобы можно было оценить память на один приостановленный бой.
+class BattleCoroutine {
+public:
+    struct promise_type {
+        static inline std::size_t liveFrames = 0;
+        static inline std::size_t liveFrameBytes = 0;
+
+        static void* operator new(std::size_t size) {
+            ++liveFrames;
+            liveFrameBytes += size;
+            return ::operator new(size);
+        }
+
+        static void operator delete(void* frame, std::size_t size) {
+            --liveFrames;
+            liveFrameBytes -= size;
+            ::operator delete(frame);
+        }
+
+        BattleCoroutine get_return_object() {
+            return BattleCoroutine(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit BattleCoroutine(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    BattleCoroutine(BattleCoroutine&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    BattleCoroutine(const BattleCoroutine&) = delete;
+    BattleCoroutine& operator=(const BattleCoroutine&) = delete;
+
+    ~BattleCoroutine() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool done() const { return handle.done(); }
+    std::coroutine_handle<> getHandle() const { return handle; }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Однопоточный планировщик сопрограмм по тикам: у каждой приостановленной
+// сопрограммы нет ни потока, ни стека - только её кадр и ссылка в колесе тиков
+class TickScheduler {
+private:
+    static constexpr std::size_t wheelSize = 64;
+
+    // Как в BattleExecutor: сопрограмма срабатывает на тике due, а не на первом проходе ячейки
+    struct Timer {
+        std::coroutine_handle<> handle;
+        std::uint64_t due;
+    };
+
+    std::vector<std::vector<Timer>> wheel{wheelSize};
+    std::uint64_t tick = 0;
+    std::size_t pending = 0;
+    std::uint64_t resumes = 0;
+
+    void scheduleAfter(std::coroutine_handle<> handle, std::uint64_t delay) {
+        const std::uint64_t due = tick + std::max<std::uint64_t>(delay, 1);
+        wheel[due % wheelSize].push_back({handle, due});
+        ++pending;
+    }
+
+public:
+    struct TickAwaiter {
+        TickScheduler& scheduler;
+        std::uint64_t delay;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { scheduler.scheduleAfter(handle, delay); }
+        void await_resume() const noexcept {}
+    };
+
+    // co_await scheduler.nextTick() - продолжить через delay тиков
+    TickAwaiter nextTick(std::uint64_t delay = 1) {
+        return TickAwaiter{*this, delay};
+    }
+
+    // Первый шаг сопрограммы выполняется на текущем тике
+    void spawn(const BattleCoroutine& battle) {
+        wheel[tick % wheelSize].push_back({battle.getHandle(), tick});
+        ++pending;
+    }
+
+    // Возобновляет сопрограммы тик за тиком, пока все не завершатся; возвращает число тиков
+    std::uint64_t run() {
+        while (pending > 0) {
+            // Возобновлённая сопрограмма может дописать в эту же ячейку таймер на следующий оборот
+            auto& slot = wheel[tick % wheelSize];
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < slot.size(); ++i) {
+                const Timer timer = slot[i];
+                if (timer.due != tick) {
+                    slot[kept++] = timer;
+                    continue;
+                }
+                --pending;
+                ++resumes;
+                timer.handle.resume();
+            }
+            slot.resize(kept);
+            ++tick;
+        }
+        return tick;
+    }
+
+    std::uint64_t getResumes() const { return resumes; }
+};
+
+// Бой как сопрограмма: каждый удар - отдельный шаг, между ударами бой ждёт следующего тика
+BattleCoroutine fight(TickScheduler& scheduler, Character& hero, Monster& monster,
+                      CombatSink& sink = nullCombatSink()) {
+    for (;;) {
+        strike(hero, monster, sink);
+        if (!monster.isAlive()) co_return;
+        co_await scheduler.nextTick();
+
+        strike(monster, hero, sink);
+        if (!hero.isAlive()) co_return;
+        co_await scheduler.nextTick();
+    }
+}
+
+// Сопрограмма без работы - для оценки чистой стоимости одного возобновления
+BattleCoroutine idle(TickScheduler& scheduler, int steps) {
+    for (int i = 0; i < steps; ++i) {
+        co_await scheduler.nextTick();
+    }
+}
+
+void benchmarkCoroutines(std::size_t battleCount) {
+    std::deque<Character> heroes;
+    std::deque<Monster> monsters;
+    std::vector<BattleCoroutine> battles;
+    battles.reserve(battleCount);
+    TickScheduler scheduler;
+    for (std::size_t i = 0; i < battleCount; ++i) {
+        const int spread = static_cast<int>(i % 50);
+        heroes.emplace_back("Hero", 60 + spread * 4, 20 + spread % 7, 10);
+        monsters.emplace_back("Goblin", 50 + spread * 6, 15 + spread % 11 * 2, 5 + spread % 3);
+        battles.push_back(fight(scheduler, heroes.back(), monsters.back()));
+        scheduler.spawn(battles.back());
+    }
+    const std::size_t frameBytes = BattleCoroutine::promise_type::liveFrameBytes;
+
+    auto start = std::chrono::steady_clock::now();
+    const std::uint64_t ticks = scheduler.run();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    TickScheduler idleScheduler;
+    std::vector<BattleCoroutine> idlers;
+    idlers.reserve(battleCount);
+    for (std::size_t i = 0; i < battleCount; ++i) {
+        idlers.push_back(idle(idleScheduler, 40));
+        idleScheduler.spawn(idlers.back());
+    }
+    start = std::chrono::steady_clock::now();
+    idleScheduler.run();
+    const double idleSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << battleCount << " боёв-сопрограмм в одном потоке: " << ticks << " тиков, "
+              << scheduler.getResumes() << " возобновлений за " << seconds << " с ("
+              << seconds * 1e9 / scheduler.getResumes() << " нс на удар)" << std::endl;
+    std::cout << "Кадр приостановленного боя: " << frameBytes / battleCount << " байт, плюс "
+              << sizeof(BattleCoroutine) + sizeof(std::coroutine_handle<>) + sizeof(std::uint64_t)
+              << " байт на владельца и место в колесе"
+              << std::endl;
+    std::cout << "Накладные расходы планировщика на возобновление: "
+              << idleSeconds * 1e9 / idleScheduler.getResumes() << " нс" << std::endl;
+}
+
+void benchmarkExecutor(std::size_t battleCount, std::size_t threads) {
+    std::deque<Character> heroes;
+    std::deque<Monster> monsters;
+    std::deque<Battle> battles;
+    std::vector<Task*> tasks;
+    for (std::size_t i = 0; i < battleCount; ++i) {
+        const int spread = static_cast<int>(i % 50);
+        heroes.emplace_back("Hero", 60 + spread * 4, 20 + spread % 7, 10);
+        monsters.emplace_back("Goblin", 50 + spread * 6, 15 + spread % 11 * 2, 5 + spread % 3);
+        battles.emplace_back(heroes.back(), monsters.back());
+        tasks.push_back(&battles.back());
+    }
+
+    BattleExecutor executor(threads);
+    const auto start = std::chrono::steady_clock::now();
+    const std::uint64_t ticks = executor.run(tasks);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::uint64_t rounds = 0;
+    std::size_t heroWins = 0;
+    for (const auto& battle : battles) {
+        rounds += battle.getRounds();
+    }
+    for (const auto& hero : heroes) {
+        heroWins += hero.isAlive();
+    }
+    std::cout << battleCount << " боёв, " << executor.threadCount() << " потоков: " << ticks << " тиков, "
+              << rounds << " раундов за " << seconds << " с" << std::endl;
+    std::cout << "Раундов в секунду на поток: "
+              << static_cast<std::uint64_t>(rounds / seconds / executor.threadCount())
+              << ", побед героя: " << heroWins << std::endl;
+}
+
+// Тысячи участников под атаками из многих потоков одновременно: прямые удары без
+// блокировок и вампирские удары в обе стороны между одними и теми же парами.
+// Потерянное здоровье должно сойтись с суммой урона минус лечение.
+bool stressDamage(std::size_t entityCount, std::size_t threadCount, std::size_t hitsPerThread) {
+    // Запас здоровья разный: часть участников погибает, и на них проверяется отсечение на нуле
+    auto startHealth = [](std::size_t i) { return 1000 + static_cast<int>(i % 16) * 1000; };
+    std::deque<Character> heroes;
+    std::deque<Monster> monsters;
+    for (std::size_t i = 0; i < entityCount / 2; ++i) {
+        heroes.emplace_back("Hero", startHealth(i), 20, 10);
+        monsters.emplace_back("Goblin", startHealth(i), 15, 5);
+    }
+
+    std::atomic<std::int64_t> totalDealt{0};
+    std::atomic<std::int64_t> totalHealed{0};
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<unsigned>(t));
+            std::uniform_int_distribution<std::size_t> pick(0, heroes.size() - 1);
+            std::uniform_int_distribution<int> damage(1, 40);
+            std::int64_t dealt = 0;
+            std::int64_t healed = 0;
+            for (std::size_t i = 0; i < hitsPerThread; ++i) {
+                Character& hero = heroes[pick(rng)];
+                Monster& monster = monsters[pick(rng)];
+                Character& ally = heroes[pick(rng)];
+                int restored = 0;
+                switch (rng() % 4) {
+                    case 0: dealt += monster.applyDamage(damage(rng)); break;
+                    case 1: dealt += hero.applyDamage(damage(rng)); break;
+                    case 2: dealt += drainLife(hero, monster, damage(rng), restored); break;
+                    default: dealt += drainLife(ally, hero, damage(rng), restored); break;
+                }
+                healed += restored;
+            }
+            totalDealt += dealt;
+            totalHealed += healed;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::int64_t lost = 0;
+    std::size_t defeated = 0;
+    bool clamped = true;
+    for (std::size_t i = 0; i < heroes.size(); ++i) {
+        lost += 2 * startHealth(i) - heroes[i].getHealth() - monsters[i].getHealth();
+        defeated += !heroes[i].isAlive() + !monsters[i].isAlive();
+        clamped = clamped && heroes[i].getHealth() >= 0 && monsters[i].getHealth() >= 0;
+    }
+    const bool consistent = clamped && lost == totalDealt - totalHealed;
+    std::cout << entityCount << " участников, " << threadCount << " потоков по " << hitsPerThread
+              << " ударов: урон " << totalDealt << ", лечение " << totalHealed << ", потеряно здоровья " << lost
+              << ", погибло " << defeated << (consistent ? " - сходится" : " - РАСХОЖДЕНИЕ") << std::endl;
+    return consistent;
 }
 
-int main() {
+// Число из командной строки: десятичное без знака и лишних символов, как parseNumber в lab1.3.cpp
+std::optional<std::uint64_t> parseNumber(const char* text) {
+    std::uint64_t value = 0;
+    const char* end = text + std::strlen(text);
+    auto [ptr, error] = std::from_chars(text, end, value);
+    if (error != std::errc() || ptr != end || ptr == text) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+int usage(const char* program) {
+    std::cerr << "Использование: " << program
+              << " [--bench [n] [потоки] | --coro [n] | --stress [участники]]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    // Необязательный аргумент: значение по умолчанию, если его нет, и nullopt, если он не число
+    auto argument = [&](int index, std::uint64_t fallback) {
+        return argc > index ? parseNumber(argv[index]) : std::optional<std::uint64_t>(fallback);
+    };
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        std::optional<std::uint64_t> battles = argument(2, 100'000);
+        std::optional<std::uint64_t> threads = argument(3, std::max(1u, std::thread::hardware_concurrency()));
+        if (!battles || *battles == 0 || !threads || *threads == 0) {
+            return usage(argv[0]);
+        }
+        benchmarkExecutor(*battles, *threads);
+        return 0;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--coro") == 0) {
+        std::optional<std::uint64_t> battles = argument(2, 50'000);
+        if (!battles || *battles == 0) {
+            return usage(argv[0]);
+        }
+        benchmarkCoroutines(*battles);
+        return 0;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--stress") == 0) {
+        // Меньше двух участников не набрать ни одной пары героя и монстра
+        std::optional<std::uint64_t> entities = argument(2, 4000);
+        if (!entities || *entities < 2) {
+            return usage(argv[0]);
+        }
+        const std::size_t threads = std::max(8u, std::thread::hardware_concurrency());
+        return stressDamage(*entities, threads, 200'000) ? 0 : 1;
+    }
+
     Character hero("Hero", 100, 20, 10);
     Monster goblin("Goblin", 50, 15, 5);
 
-    std::thread battleThread(battle, std::ref(hero), std::ref(goblin));
-    
-    // Ждем завершения боя
-    battleThread.join();
+    // Раунды идут раз в секунду, но вместо отдельного потока на бой ими управляет исполнитель
+    TextCombatSink console(std::cout);
+    Battle duel(hero, goblin, console);
+    BattleExecutor executor(1, std::chrono::seconds(1));
+    executor.run({&duel});
 
     // Вывод результатов
     std::cout << "\nBattle results:" << std::endl;
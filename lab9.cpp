@@ -5,34 +5,1103 @@
 #include <stdexcept>
 #include <algorithm>
 #include <memory>
+#include <functional>
+#include <optional>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <filesystem>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <cerrno>
+#include <fcntl.h>
+#include <zlib.h> // сжатие архивов лога, сборка: g++ -std=c++20 -O2 -pthread lab9.cpp -lz
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
-// Шаблонный класс Logger
+// Режим работы логгера
+enum class LogMode {
+    SYNC,  // запись каждого сообщения сразу
+    ASYNC  // очередь и фоновый поток записи
+};
+
+// Что делать, если очередь асинхронного логгера заполнена
+enum class Backpressure {
+    BLOCK,  // ждать освобождения места
+    DROP,   // отбросить сообщение
+    SAMPLE  // записать каждое sampleRate-е сообщение, остальные отбросить
+};
+
+struct LoggerOptions {
+    LogMode mode = LogMode::ASYNC;
+    std::size_t capacity = 4096;                   // записей в очереди, степень двойки
+    std::chrono::milliseconds flushInterval{50};   // максимальная задержка записи в файл
+    std::size_t batchBytes = 64 * 1024;            // пакет, который записывается сразу
+    Backpressure backpressure = Backpressure::BLOCK;
+    unsigned sampleRate = 16;
+    std::size_t rotateBytes = 0;                   // 0 — без ротации по размеру
+    std::chrono::seconds rotateInterval{0};        // 0 — без ротации по времени
+    bool compressArchives = true;                  // сжимать закрытые сегменты в фоне
+};
+
+// Ограниченная очередь многих производителей и одного потребителя без блокировок
+// (ячейки с номерами последовательности). Строки ячеек сохраняют емкость,
+// поэтому в установившемся режиме запись не выделяет память
+class LogRing {
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        std::string text;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> enqueuePos{0};
+    alignas(64) std::atomic<std::size_t> dequeuePos{0};
+
+public:
+    explicit LogRing(std::size_t capacity) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("Log queue capacity must be a power of two");
+        }
+        cells = std::make_unique<Cell[]>(capacity);
+        mask = capacity - 1;
+        for (std::size_t i = 0; i < capacity; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool tryPush(std::string_view message) {
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->text.assign(message);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Только для потока-потребителя: дописывает запись в out
+    bool tryPop(std::string& out) {
+        std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = cells[pos & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1) return false;
+        out.append(cell.text);
+        cell.sequence.store(pos + mask + 1, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t pushed() const { return enqueuePos.load(std::memory_order_acquire); }
+    std::size_t popped() const { return dequeuePos.load(std::memory_order_acquire); }
+    std::size_t capacity() const { return mask + 1; }
+};
+
+// Сегмент лога из индекса: файл и интервал времени записи (мс от эпохи).
+// Сжатый сегмент лежит рядом с суффиксом .gz
+struct LogSegment {
+    std::string path;
+    std::uint64_t firstMs = 0;
+    std::uint64_t lastMs = 0;
+};
+
+std::uint64_t logClockMs() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// Закрытые сегменты по порядку; строки индекса: "первое_время последнее_время файл"
+std::vector<LogSegment> readLogIndex(const std::string& logPath) {
+    std::vector<LogSegment> segments;
+    std::ifstream index(logPath + ".index");
+    LogSegment segment;
+    while (index >> segment.firstMs >> segment.lastMs >> std::ws && std::getline(index, segment.path)) {
+        if (!std::filesystem::exists(segment.path) && std::filesystem::exists(segment.path + ".gz")) {
+            segment.path += ".gz";
+        }
+        segments.push_back(segment);
+    }
+    return segments;
+}
+
+// Сегменты, которые могут содержать записи из [fromMs, toMs], включая текущий файл.
+// Текущий файл читается всегда: запись, задержанная в очереди, может оказаться в нем
+// со временем раньше конца предыдущего сегмента
+std::vector<LogSegment> logSegmentsBetween(const std::string& logPath, std::uint64_t fromMs, std::uint64_t toMs) {
+    std::vector<LogSegment> result;
+    for (LogSegment& segment : readLogIndex(logPath)) {
+        if (segment.lastMs >= fromMs && segment.firstMs <= toMs) result.push_back(std::move(segment));
+    }
+    if (std::filesystem::exists(logPath)) {
+        result.push_back({logPath, 0, std::numeric_limits<std::uint64_t>::max()});
+    }
+    return result;
+}
+
+// Сжатие закрытого сегмента в path.gz; исходный файл удаляется после успешной записи
+void compressLogSegment(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::string tmpName = path + ".gz.tmp";
+    gzFile out = gzopen(tmpName.c_str(), "wb6");
+    if (!in || !out) {
+        if (out) gzclose(out);
+        std::cerr << "Error: Failed to compress " << path << "\n";
+        return;
+    }
+    std::vector<char> chunk(64 * 1024);
+    bool ok = true;
+    while (ok && in) {
+        in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        if (in.gcount() > 0) ok = gzwrite(out, chunk.data(), static_cast<unsigned>(in.gcount())) == in.gcount();
+    }
+    ok = gzclose(out) == Z_OK && ok;
+    if (!ok || std::rename(tmpName.c_str(), (path + ".gz").c_str()) != 0) {
+        std::filesystem::remove(tmpName);
+        std::cerr << "Error: Failed to compress " << path << "\n";
+        return;
+    }
+    std::filesystem::remove(path);
+}
+
+// Запись в файл лога: один раз открытый дескриптор; в асинхронном режиме
+// записи копятся в очереди и пишутся фоновым потоком крупными блоками.
+// Текстовый поток делится на строки, двоичный пишется как есть.
+// При ротации текущий файл переименовывается в path.NNNNNN и заносится в индекс,
+// его место занимает заранее подготовленный сегмент; подготовку следующего
+// сегмента и сжатие закрытых выполняет отдельный фоновый поток
+class LogWriter {
+public:
+    // Дописывает в пакет отметку о потерянных записях
+    using DropNote = void (*)(std::string& out, std::size_t lost);
+    // Время записи (мс от эпохи) для границ сегмента в индексе; читает не больше
+    // первых recordTimeBytes байт записи
+    using RecordTime = std::uint64_t (*)(std::string_view record);
+    static constexpr std::size_t recordTimeBytes = 12;
+
+private:
+    std::string path;
+    LoggerOptions options;
+    bool lines;
+    DropNote dropNote;
+    RecordTime recordTime;
+    std::string header;
+    int fd = -1;
+
+    // Текущий сегмент; меняется только пишущим потоком (или под writeMutex)
+    std::uint64_t segmentBytes = 0;
+    std::uint64_t firstMs = std::numeric_limits<std::uint64_t>::max();
+    std::uint64_t lastMs = 0;
+    std::chrono::steady_clock::time_point segmentOpened = std::chrono::steady_clock::now();
+    unsigned archiveSeq = 0;
+
+    // Фоновая подготовка сегментов и сжатие архивов
+    std::thread archiver;
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::condition_variable prepared;
+    std::vector<std::string> compressJobs;
+    bool prepareJob = false;
+    bool preparing = false;
+    bool archiverStop = false;
+    int preparedFd = -1;
+
+    std::mutex writeMutex; // синхронный режим
+    std::unique_ptr<LogRing> ring;
+    std::thread writer;
+    std::mutex wakeMutex;
+    std::condition_variable wake;     // будит поток записи
+    std::condition_variable flushed;  // сообщает о записанных сообщениях
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> urgent{false};
+    std::atomic<std::size_t> written{0};
+    std::atomic<std::size_t> dropped{0};
+    std::atomic<std::size_t> sampleCounter{0};
+
+    void writeAll(std::string_view data) {
+        while (!data.empty()) {
+            ssize_t n = ::write(fd, data.data(), data.size());
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Error: Failed to write log file\n";
+                return;
+            }
+            data.remove_prefix(static_cast<std::size_t>(n));
+        }
+    }
+
+    bool rotating() const {
+        return options.rotateBytes > 0 || options.rotateInterval.count() > 0;
+    }
+
+    // Новый сегмент path.next с заголовком; место под него выделяется заранее,
+    // размер файла при этом не меняется
+    int prepareSegment() {
+        std::string nextPath = path + ".next";
+        int next = ::open(nextPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+        if (next < 0) return -1;
+        if (options.rotateBytes > 0) {
+            ::fallocate(next, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(options.rotateBytes));
+        }
+        std::string_view data = header;
+        while (!data.empty()) {
+            ssize_t n = ::write(next, data.data(), data.size());
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                ::close(next);
+                return -1;
+            }
+            data.remove_prefix(static_cast<std::size_t>(n));
+        }
+        return next;
+    }
+
+    void runArchiver() {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        while (true) {
+            jobReady.wait(lock, [this] { return archiverStop || prepareJob || !compressJobs.empty(); });
+            if (prepareJob && !archiverStop) {
+                prepareJob = false;
+                preparing = true;
+                lock.unlock();
+                int next = prepareSegment();
+                lock.lock();
+                preparing = false;
+                preparedFd = next;
+                prepared.notify_all();
+                continue;
+            }
+            if (!compressJobs.empty()) {
+                std::string archive = std::move(compressJobs.front());
+                compressJobs.erase(compressJobs.begin());
+                lock.unlock();
+                compressLogSegment(archive);
+                lock.lock();
+                continue;
+            }
+            if (archiverStop) return;
+        }
+    }
+
+    bool rotationDue(std::size_t incoming) const {
+        if (!rotating() || segmentBytes <= header.size()) return false;
+        if (options.rotateBytes > 0 && segmentBytes + incoming > options.rotateBytes) return true;
+        return options.rotateInterval.count() > 0 &&
+               std::chrono::steady_clock::now() - segmentOpened >= options.rotateInterval;
+    }
+
+    // Закрытие текущего сегмента: переименование, запись в индекс, переход на подготовленный
+    void rotate() {
+        int next;
+        {
+            // Начатую подготовку дожидаемся, не начатую выполняем сами
+            std::unique_lock<std::mutex> lock(jobMutex);
+            prepared.wait(lock, [this] { return !preparing; });
+            next = preparedFd;
+            preparedFd = -1;
+            prepareJob = false;
+        }
+        if (next < 0) next = prepareSegment();
+        if (next < 0) {
+            std::cerr << "Error: Failed to rotate log file\n";
+            return;
+        }
+
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), ".%06u", ++archiveSeq);
+        std::string archive = path + suffix;
+        if (std::rename(path.c_str(), archive.c_str()) != 0 ||
+            std::rename((path + ".next").c_str(), path.c_str()) != 0) {
+            ::close(next);
+            std::cerr << "Error: Failed to rotate log file\n";
+            return;
+        }
+        ::close(fd);
+        fd = next;
+        std::ofstream(path + ".index", std::ios::app) << firstMs << ' ' << lastMs << ' ' << archive << '\n';
+
+        segmentBytes = header.size();
+        firstMs = std::numeric_limits<std::uint64_t>::max();
+        lastMs = 0;
+        segmentOpened = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            if (options.compressArchives) compressJobs.push_back(archive);
+            prepareJob = true;
+        }
+        jobReady.notify_one();
+    }
+
+    // Сегмент, оставшийся от прошлого запуска, продолжается: его начало — время первой
+    // записи или создания файла (что раньше), конец — время последнего изменения.
+    // От начала сегмента, а не от запуска процесса, отсчитывается и интервал ротации.
+    // Если начало узнать нельзя, сегмент считается начатым в эпоху и закрывается первой записью
+    void recoverSegment() {
+        struct statx info;
+        if (::statx(AT_FDCWD, path.c_str(), 0, STATX_BTIME | STATX_MTIME, &info) != 0) return;
+        auto toMs = [](const statx_timestamp& time) {
+            return static_cast<std::uint64_t>(time.tv_sec) * 1000 + time.tv_nsec / 1000000;
+        };
+        lastMs = toMs(info.stx_mtime);
+        firstMs = (info.stx_mask & STATX_BTIME) ? toMs(info.stx_btime) : 0;
+        if (recordTime) {
+            std::ifstream in(path, std::ios::binary);
+            char record[recordTimeBytes];
+            if (in.seekg(static_cast<std::streamoff>(header.size())) && in.read(record, sizeof(record))) {
+                std::uint64_t ms = recordTime(std::string_view(record, sizeof(record)));
+                firstMs = (info.stx_mask & STATX_BTIME) ? std::min(firstMs, ms) : ms;
+            }
+        }
+        firstMs = std::min(firstMs, lastMs);
+        std::uint64_t now = logClockMs();
+        if (firstMs < now) segmentOpened -= std::chrono::milliseconds(now - firstMs);
+    }
+
+    void stamp(std::string_view record, std::uint64_t& fromMs, std::uint64_t& toMs) const {
+        if (!recordTime) return;
+        std::uint64_t ms = recordTime(record);
+        fromMs = std::min(fromMs, ms);
+        toMs = std::max(toMs, ms);
+    }
+
+    // [fromMs, toMs] — время записей в data; пустой интервал — записи без времени,
+    // тогда сегмент помечается временем записи в файл
+    void writeSegment(std::string_view data, std::uint64_t fromMs, std::uint64_t toMs) {
+        if (rotationDue(data.size())) rotate();
+        writeAll(data);
+        segmentBytes += data.size();
+        if (fromMs > toMs) fromMs = toMs = logClockMs();
+        firstMs = std::min(firstMs, fromMs);
+        lastMs = std::max(lastMs, toMs);
+    }
+
+    void wakeWriter() {
+        urgent.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wake.notify_one();
+    }
+
+    void push(std::string_view record) {
+        if (ring->tryPush(record)) {
+            // Очередь заполнена наполовину — поток записи не ждет конца интервала
+            if (ring->pushed() - ring->popped() >= ring->capacity() / 2 && !urgent.load(std::memory_order_relaxed)) {
+                wakeWriter();
+            }
+            return;
+        }
+        switch (options.backpressure) {
+            case Backpressure::DROP:
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            case Backpressure::SAMPLE:
+                if (sampleCounter.fetch_add(1, std::memory_order_relaxed) % options.sampleRate != 0) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                break;
+            case Backpressure::BLOCK:
+                break;
+        }
+        while (!ring->tryPush(record)) {
+            wakeWriter();
+            std::this_thread::yield();
+        }
+    }
+
+    void run() {
+        std::string batch;
+        batch.reserve(options.batchBytes * 2);
+        std::size_t reportedDrops = 0;
+        std::uint64_t batchFrom = std::numeric_limits<std::uint64_t>::max();
+        std::uint64_t batchTo = 0;
+        auto lastWrite = std::chrono::steady_clock::now();
+        while (true) {
+            bool wasUrgent = urgent.exchange(false, std::memory_order_acq_rel);
+            std::size_t count = 0;
+            for (std::size_t start = batch.size(); batch.size() < options.batchBytes && ring->tryPop(batch);
+                 start = batch.size()) {
+                stamp(std::string_view(batch).substr(start), batchFrom, batchTo);
+                if (lines) batch.push_back('\n');
+                ++count;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            bool stop = stopping.load(std::memory_order_acquire);
+            bool due = wasUrgent || stop || now - lastWrite >= options.flushInterval;
+            if (!batch.empty() && (batch.size() >= options.batchBytes || due)) {
+                std::size_t lost = dropped.load(std::memory_order_relaxed);
+                if (lost != reportedDrops) {
+                    std::size_t start = batch.size();
+                    dropNote(batch, lost - reportedDrops);
+                    stamp(std::string_view(batch).substr(start), batchFrom, batchTo);
+                    reportedDrops = lost;
+                }
+                writeSegment(batch, batchFrom, batchTo);
+                batch.clear();
+                batchFrom = std::numeric_limits<std::uint64_t>::max();
+                batchTo = 0;
+                lastWrite = now;
+                written.store(ring->popped(), std::memory_order_release);
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                flushed.notify_all();
+                continue;
+            }
+            if (count > 0) continue;
+            if (stop && ring->popped() == ring->pushed()) break;
+
+            // Ждем новых сообщений или конца интервала для уже накопленных
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_until(lock, lastWrite + options.flushInterval, [this] {
+                return urgent.load(std::memory_order_acquire) || stopping.load(std::memory_order_acquire);
+            });
+            if (batch.empty() && !urgent.load(std::memory_order_relaxed)) lastWrite = std::chrono::steady_clock::now();
+        }
+    }
+
+public:
+    // header записывается в начало каждого нового сегмента
+    LogWriter(const std::string& filename, LoggerOptions opts, bool lines, DropNote dropNote,
+              RecordTime recordTime = nullptr, std::string_view header = {})
+        : path(filename), options(opts), lines(lines), dropNote(dropNote), recordTime(recordTime), header(header) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) throw std::runtime_error("Failed to open log file");
+        struct stat info;
+        if (::fstat(fd, &info) == 0) segmentBytes = static_cast<std::uint64_t>(info.st_size);
+        if (segmentBytes == 0 && !this->header.empty()) {
+            writeAll(this->header);
+            segmentBytes = this->header.size();
+        }
+        if (rotating()) {
+            if (segmentBytes > this->header.size()) recoverSegment();
+            // Нумерация архивов продолжается с последнего сегмента в индексе
+            for (const LogSegment& segment : readLogIndex(path)) {
+                std::string_view name = segment.path;
+                if (name.ends_with(".gz")) name.remove_suffix(3);
+                archiveSeq = std::max(archiveSeq, static_cast<unsigned>(
+                    std::strtoul(std::string(name.substr(name.rfind('.') + 1)).c_str(), nullptr, 10)));
+            }
+            prepareJob = true;
+            archiver = std::thread([this] { runArchiver(); });
+        }
+        if (options.mode == LogMode::ASYNC) {
+            if (options.sampleRate == 0) options.sampleRate = 1;
+            ring = std::make_unique<LogRing>(options.capacity);
+            writer = std::thread([this] { run(); });
+        }
+    }
+
+    // Очередь дописывается в файл до закрытия, начатое сжатие архивов завершается
+    ~LogWriter() {
+        if (writer.joinable()) {
+            stopping.store(true, std::memory_order_release);
+            wakeWriter();
+            writer.join();
+        }
+        if (archiver.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                archiverStop = true;
+            }
+            jobReady.notify_one();
+            archiver.join();
+            if (preparedFd >= 0) ::close(preparedFd);
+            std::filesystem::remove(path + ".next");
+        }
+        ::close(fd);
+    }
+
+    LogWriter(const LogWriter&) = delete;
+    LogWriter& operator=(const LogWriter&) = delete;
+
+    void write(std::string_view record) {
+        if (ring) {
+            push(record);
+            return;
+        }
+        std::uint64_t fromMs = std::numeric_limits<std::uint64_t>::max();
+        std::uint64_t toMs = 0;
+        stamp(record, fromMs, toMs);
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if (lines) {
+            std::string line(record);
+            line.push_back('\n');
+            writeSegment(line, fromMs, toMs);
+        } else {
+            writeSegment(record, fromMs, toMs);
+        }
+    }
+
+    // Ожидание записи всех сообщений, принятых до вызова
+    void flush() {
+        if (!ring) return;
+        std::size_t target = ring->pushed();
+        wakeWriter();
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        flushed.wait(lock, [&] { return written.load(std::memory_order_acquire) >= target; });
+    }
+
+    std::size_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+// Шаблонный класс Logger: текстовый лог, по строке на сообщение
 template<typename T>
 class Logger {
 private:
     std::string filename;
+    LogWriter writer;
+
+    static void dropNote(std::string& out, std::size_t lost) {
+        out += "[logger] " + std::to_string(lost) + " messages dropped\n";
+    }
 
 public:
-    Logger(const std::string& fname) : filename(fname) {}
+    Logger(const std::string& fname, LoggerOptions opts = {})
+        : filename(fname), writer(fname, opts, true, dropNote) {}
 
     void log(const T& message) {
-        std::ofstream file(filename, std::ios::app);
-        if (!file) throw std::runtime_error("Failed to open log file");
-        file << message << std::endl;
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            writer.write(std::string_view(message));
+        } else {
+            std::ostringstream out;
+            out << message;
+            writer.write(out.str());
+        }
+    }
+
+    void flush() { writer.flush(); }
+    std::size_t droppedCount() const { return writer.droppedCount(); }
+};
+
+// Форматы структурированных записей; {} заменяются аргументами при декодировании.
+// Идентификаторы хранятся в файлах, поэтому новые форматы добавляются только в конец
+enum class LogEvent : std::uint16_t {
+    MESSAGES_DROPPED = 1,
+    CHARACTER_CREATED,
+    ENCOUNTER,
+    MONSTER_DEFEATED,
+    GAME_SAVED,
+    GAME_LOADED,
+    COMBAT_ATTACK,
+    COMBAT_NO_EFFECT,
+    COMBAT_CRIT,
+    COMBAT_POISON,
+    COMBAT_HEAL,
+    COMBAT_DEFEAT,
+    COMBAT_LEVEL_UP
+};
+
+const char* logEventFormat(LogEvent event) {
+    switch(event) {
+        case LogEvent::MESSAGES_DROPPED: return "[logger] {} messages dropped";
+        case LogEvent::CHARACTER_CREATED: return "Character created: {}";
+        case LogEvent::ENCOUNTER: return "{} encountered a {}";
+        case LogEvent::MONSTER_DEFEATED: return "{} defeated {}";
+        case LogEvent::GAME_SAVED: return "Game saved to {}";
+        case LogEvent::GAME_LOADED: return "Game loaded from {}";
+        case LogEvent::COMBAT_ATTACK: return "{} attacks {} for {} damage!";
+        case LogEvent::COMBAT_NO_EFFECT: return "{} attacks {}, but it has no effect!";
+        case LogEvent::COMBAT_CRIT: return "Critical hit! {} attacks {} for {} damage!";
+        case LogEvent::COMBAT_POISON: return "Poisonous attack! {} attacks {} for {} damage!";
+        case LogEvent::COMBAT_HEAL: return "{} heals for {} HP!";
+        case LogEvent::COMBAT_DEFEAT: return "{} has defeated {}!";
+        case LogEvent::COMBAT_LEVEL_UP: return "{} leveled up to level {}!";
+    }
+    return nullptr;
+}
+
+constexpr char binaryLogMagic[8] = {'G', 'L', 'O', 'G', 'B', 'I', 'N', '1'};
+
+// Тип аргумента в двоичной записи
+enum class LogArg : std::uint8_t {
+    INT = 1,    // int64
+    DOUBLE,     // double
+    STRING      // u16 длина и байты
+};
+
+// Двоичная запись лога во внутреннем буфере, без выделения памяти:
+// u16 длина записи, u16 формат, u64 время (нс от эпохи), u8 число аргументов, аргументы.
+// Строки, не помещающиеся в запись, обрезаются
+class LogRecord {
+public:
+    static constexpr std::size_t maxSize = 512;
+    static constexpr std::size_t headerSize = 13;
+
+private:
+    std::array<char, maxSize> buffer;
+    std::size_t size = headerSize;
+    std::uint8_t argCount = 0;
+
+    void put(const void* bytes, std::size_t length) {
+        std::memcpy(buffer.data() + size, bytes, length);
+        size += length;
+    }
+
+    void putTag(LogArg tag) { put(&tag, sizeof(tag)); }
+
+public:
+    explicit LogRecord(LogEvent event) {
+        auto id = static_cast<std::uint16_t>(event);
+        // Грубые часы (точность — тик ядра) в несколько раз дешевле точных
+        timespec now;
+        ::clock_gettime(CLOCK_REALTIME_COARSE, &now);
+        auto time = static_cast<std::uint64_t>(now.tv_sec) * 1000000000 + static_cast<std::uint64_t>(now.tv_nsec);
+        std::memcpy(buffer.data() + 2, &id, sizeof(id));
+        std::memcpy(buffer.data() + 4, &time, sizeof(time));
+    }
+
+    template<typename Arg>
+    void add(const Arg& arg) {
+        if constexpr (std::is_integral_v<Arg> || std::is_enum_v<Arg>) {
+            if (size + 1 + sizeof(std::int64_t) > maxSize) return;
+            auto value = static_cast<std::int64_t>(arg);
+            putTag(LogArg::INT);
+            put(&value, sizeof(value));
+        } else if constexpr (std::is_floating_point_v<Arg>) {
+            if (size + 1 + sizeof(double) > maxSize) return;
+            auto value = static_cast<double>(arg);
+            putTag(LogArg::DOUBLE);
+            put(&value, sizeof(value));
+        } else {
+            std::string_view text(arg);
+            if (size + 3 > maxSize) return;
+            auto length = static_cast<std::uint16_t>(std::min(text.size(), maxSize - size - 3));
+            putTag(LogArg::STRING);
+            put(&length, sizeof(length));
+            put(text.data(), length);
+        }
+        ++argCount;
+    }
+
+    std::string_view bytes() {
+        auto length = static_cast<std::uint16_t>(size);
+        std::memcpy(buffer.data(), &length, sizeof(length));
+        buffer[12] = static_cast<char>(argCount);
+        return {buffer.data(), size};
+    }
+};
+
+// Структурированный лог: формат и типизированные аргументы без форматирования
+// строк в момент вызова; текст получается декодером (--decode)
+class StructuredLogger {
+    LogWriter writer;
+
+    static void dropNote(std::string& out, std::size_t lost) {
+        LogRecord record(LogEvent::MESSAGES_DROPPED);
+        record.add(lost);
+        out.append(record.bytes());
+    }
+
+    static std::uint64_t recordTime(std::string_view record) {
+        static_assert(4 + sizeof(std::uint64_t) <= LogWriter::recordTimeBytes);
+        std::uint64_t time;
+        std::memcpy(&time, record.data() + 4, sizeof(time));
+        return time / 1000000;
+    }
+
+public:
+    StructuredLogger(const std::string& filename, LoggerOptions opts = {})
+        : writer(filename, opts, false, dropNote, recordTime,
+                 std::string_view(binaryLogMagic, sizeof(binaryLogMagic))) {}
+
+    template<typename... Args>
+    void log(LogEvent event, const Args&... args) {
+        LogRecord record(event);
+        (record.add(args), ...);
+        writer.write(record.bytes());
+    }
+
+    void flush() { writer.flush(); }
+    std::size_t droppedCount() const { return writer.droppedCount(); }
+};
+
+// Перевод двоичного лога (сегмента, в том числе сжатого) в текст: время и сообщение
+// на строку. Выводятся только записи со временем из [fromNs, toNs]
+void decodeLog(const std::string& filename, std::ostream& out,
+               std::uint64_t fromNs = 0, std::uint64_t toNs = std::numeric_limits<std::uint64_t>::max()) {
+    gzFile file = gzopen(filename.c_str(), "rb"); // несжатый файл читается как есть
+    if (!file) throw std::runtime_error("Failed to open log file");
+    std::string data;
+    std::vector<char> chunk(64 * 1024);
+    for (int n; (n = gzread(file, chunk.data(), static_cast<unsigned>(chunk.size()))) > 0;) data.append(chunk.data(), n);
+    gzclose(file);
+    if (data.size() < sizeof(binaryLogMagic) ||
+        std::memcmp(data.data(), binaryLogMagic, sizeof(binaryLogMagic)) != 0) {
+        throw std::runtime_error("Not a binary game log");
+    }
+
+    auto read = [&data](std::size_t pos, auto& value) { std::memcpy(&value, data.data() + pos, sizeof(value)); };
+    std::size_t pos = sizeof(binaryLogMagic);
+    while (pos < data.size()) {
+        std::uint16_t length = 0;
+        if (data.size() - pos < LogRecord::headerSize) break;
+        read(pos, length);
+        if (length < LogRecord::headerSize || length > data.size() - pos) break;
+        std::uint16_t id;
+        std::uint64_t time;
+        read(pos + 2, id);
+        read(pos + 4, time);
+        std::uint8_t argCount = static_cast<std::uint8_t>(data[pos + 12]);
+        if (time < fromNs || time > toNs) {
+            pos += length;
+            continue;
+        }
+
+        // Аргументы в текстовом виде
+        std::vector<std::string> args;
+        std::size_t cursor = pos + LogRecord::headerSize;
+        std::size_t end = pos + length;
+        for (std::uint8_t i = 0; i < argCount && cursor < end; ++i) {
+            auto tag = static_cast<LogArg>(data[cursor++]);
+            if (tag == LogArg::INT && end - cursor >= 8) {
+                std::int64_t value;
+                read(cursor, value);
+                args.push_back(std::to_string(value));
+                cursor += 8;
+            } else if (tag == LogArg::DOUBLE && end - cursor >= 8) {
+                double value;
+                read(cursor, value);
+                std::ostringstream text;
+                text << value;
+                args.push_back(text.str());
+                cursor += 8;
+            } else if (tag == LogArg::STRING && end - cursor >= 2) {
+                std::uint16_t size;
+                read(cursor, size);
+                cursor += 2;
+                size = static_cast<std::uint16_t>(std::min<std::size_t>(size, end - cursor));
+                args.emplace_back(data.data() + cursor, size);
+                cursor += size;
+            } else {
+                break;
+            }
+        }
+
+        std::time_t seconds = static_cast<std::time_t>(time / 1000000000);
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+        out << stamp << '.' << std::setw(3) << std::setfill('0') << time / 1000000 % 1000 << ' ';
+
+        const char* format = logEventFormat(static_cast<LogEvent>(id));
+        std::size_t next = 0;
+        if (format) {
+            for (std::string_view rest(format); !rest.empty();) {
+                std::size_t hole = rest.find("{}");
+                out << rest.substr(0, hole);
+                if (hole == std::string_view::npos) break;
+                out << (next < args.size() ? args[next++] : "?");
+                rest.remove_prefix(hole + 2);
+            }
+        } else {
+            out << "<unknown event " << id << ">";
+        }
+        for (; next < args.size(); ++next) out << ' ' << args[next];
+        out << '\n';
+        pos += length;
+    }
+    if (pos != data.size()) std::cerr << "Warning: truncated record at offset " << pos << "\n";
+}
+
+// Записи за интервал времени: читаются только сегменты из индекса, пересекающие его
+void queryLog(const std::string& logPath, std::uint64_t fromMs, std::uint64_t toMs, std::ostream& out) {
+    for (const LogSegment& segment : logSegmentsBetween(logPath, fromMs, toMs)) {
+        decodeLog(segment.path, out, fromMs * 1000000, toMs * 1000000 + 999999);
+    }
+}
+
+// Местное время "ГГГГ-ММ-ДД ЧЧ:ММ:СС" в мс от эпохи
+std::uint64_t parseLogTime(const std::string& text) {
+    std::tm local{};
+    std::istringstream in(text);
+    in >> std::get_time(&local, "%Y-%m-%d %H:%M:%S");
+    if (in.fail()) throw std::runtime_error("Invalid time: " + text);
+    local.tm_isdst = -1;
+    return static_cast<std::uint64_t>(std::mktime(&local)) * 1000;
+}
+
+// Генератор боевой случайности: копия CombatRng, combatRng, seedCombatRng и parseNumber
+// из lab1.3.cpp, пояснения там. Копии намеренно одинаковые: изменения вносятся в обе
+class CombatRng {
+private:
+    std::array<std::uint64_t, 4> state;
+
+    static std::uint64_t splitMix(std::uint64_t& x) {
+        std::uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    explicit CombatRng(std::uint64_t seed, std::uint64_t stream = 0) {
+        std::uint64_t streamKey = stream;
+        std::uint64_t x = seed ^ splitMix(streamKey);
+        for (auto& word : state) {
+            word = splitMix(x);
+        }
     }
+
+    std::uint64_t next() {
+        const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    std::uint32_t below(std::uint32_t bound) {
+        std::uint64_t m = (next() >> 32) * bound;
+        auto low = static_cast<std::uint32_t>(m);
+        if (low < bound) {
+            const std::uint32_t threshold = -bound % bound;
+            while (low < threshold) {
+                m = (next() >> 32) * bound;
+                low = static_cast<std::uint32_t>(m);
+            }
+        }
+        return static_cast<std::uint32_t>(m >> 32);
+    }
+
+    void fillRolls(std::uint8_t* out, std::size_t n, std::uint8_t bound = 100) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = static_cast<std::uint8_t>(below(bound));
+        }
+    }
+};
+
+CombatRng& combatRng() {
+    thread_local CombatRng rng(static_cast<std::uint64_t>(std::time(nullptr)),
+                               std::hash<std::thread::id>()(std::this_thread::get_id()));
+    return rng;
+}
+
+void seedCombatRng(std::uint64_t seed, std::uint64_t stream = 0) {
+    combatRng() = CombatRng(seed, stream);
+}
+
+std::optional<std::uint64_t> parseNumber(const char* text) {
+    std::uint64_t value = 0;
+    const char* end = text + std::strlen(text);
+    auto [ptr, error] = std::from_chars(text, end, value);
+    if (error != std::errc() || ptr != end || ptr == text) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// События боя. Симуляция только создаёт небольшие записи и передаёт их приёмнику;
+// текст (если он нужен) собирается приёмником позже, вне цикла боя
+enum class CombatEventType : std::uint8_t {
+    ATTACK,
+    NO_EFFECT,
+    CRIT,
+    POISON,
+    HEAL,
+    DEFEAT,
+    LEVEL_UP
+};
+
+// Участники записываются номерами имён из combatNameId; value - урон, лечение или уровень
+struct CombatEvent {
+    CombatEventType type;
+    std::uint32_t source;
+    std::uint32_t target;
+    std::int32_t value;
+};
+
+// Таблица имён участников боя: одно имя - один номер на всё время работы программы.
+// Сущности создаются в любых потоках, поэтому таблица под мьютексом; deque не перемещает
+// строки при росте, и ссылка из combatName остаётся действительной после разблокировки
+struct CombatNameTable {
+    std::mutex mtx;
+    std::deque<std::string> names;
+    std::unordered_map<std::string, std::uint32_t> ids;
+};
+
+CombatNameTable& combatNames() {
+    static CombatNameTable table;
+    return table;
+}
+
+std::uint32_t combatNameId(const std::string& name) {
+    CombatNameTable& table = combatNames();
+    std::lock_guard<std::mutex> lock(table.mtx);
+    auto [it, inserted] = table.ids.try_emplace(name, static_cast<std::uint32_t>(table.names.size()));
+    if (inserted) table.names.push_back(name);
+    return it->second;
+}
+
+const std::string& combatName(std::uint32_t id) {
+    CombatNameTable& table = combatNames();
+    std::lock_guard<std::mutex> lock(table.mtx);
+    return table.names[id];
+}
+
+// Приёмник событий боя
+class CombatSink {
+public:
+    virtual ~CombatSink() = default;
+    virtual void emit(const CombatEvent& event) = 0;
+    virtual void flush() {}
+};
+
+// Безголовый режим: события отбрасываются, форматирования нет совсем
+class NullCombatSink : public CombatSink {
+public:
+    void emit(const CombatEvent&) override {}
+};
+
+// События в памяти - для проверок
+class MemoryCombatSink : public CombatSink {
+    std::vector<CombatEvent> events;
+
+public:
+    void emit(const CombatEvent& event) override { events.push_back(event); }
+    const std::vector<CombatEvent>& getEvents() const { return events; }
+    void clear() { events.clear(); }
+};
+
+// Текст для консоли: события копятся в буфере и форматируются пачкой при flush()
+// или при заполнении буфера, одной записью в поток
+class TextCombatSink : public CombatSink {
+    std::ostream& out;
+    std::vector<CombatEvent> pending;
+    std::size_t capacity;
+
+    static void render(std::string& text, const CombatEvent& e) {
+        const std::string& source = combatName(e.source);
+        const std::string& target = combatName(e.target);
+        const std::string value = std::to_string(e.value);
+        switch (e.type) {
+            case CombatEventType::ATTACK: text += source + " attacks " + target + " for " + value + " damage!\n"; break;
+            case CombatEventType::NO_EFFECT: text += source + " attacks " + target + ", but it has no effect!\n"; break;
+            case CombatEventType::CRIT: text += "Critical hit! " + source + " attacks " + target + " for " + value + " damage!\n"; break;
+            case CombatEventType::POISON: text += "Poisonous attack! " + source + " attacks " + target + " for " + value + " damage!\n"; break;
+            case CombatEventType::HEAL: text += target + " heals for " + value + " HP!\n"; break;
+            case CombatEventType::DEFEAT: text += target + " has been defeated!\n"; break;
+            case CombatEventType::LEVEL_UP: text += target + " leveled up to level " + value + "!\n"; break;
+        }
+    }
+
+public:
+    explicit TextCombatSink(std::ostream& out, std::size_t capacity = 256) : out(out), capacity(capacity) {
+        pending.reserve(capacity);
+    }
+
+    ~TextCombatSink() override { flush(); }
+
+    void emit(const CombatEvent& event) override {
+        pending.push_back(event);
+        if (pending.size() >= capacity) flush();
+    }
+
+    void flush() override {
+        if (pending.empty()) return;
+        std::string text;
+        for (const auto& event : pending) render(text, event);
+        pending.clear();
+        out << text << std::flush;
+    }
+};
+
+// Двоичный файл событий в формате структурированного лога; читается через --decode
+class BinaryCombatSink : public CombatSink {
+    StructuredLogger logger;
+
+public:
+    explicit BinaryCombatSink(const std::string& filename) : logger(filename) {}
+
+    void emit(const CombatEvent& e) override {
+        const std::string& source = combatName(e.source);
+        const std::string& target = combatName(e.target);
+        switch (e.type) {
+            case CombatEventType::ATTACK: logger.log(LogEvent::COMBAT_ATTACK, source, target, e.value); break;
+            case CombatEventType::NO_EFFECT: logger.log(LogEvent::COMBAT_NO_EFFECT, source, target); break;
+            case CombatEventType::CRIT: logger.log(LogEvent::COMBAT_CRIT, source, target, e.value); break;
+            case CombatEventType::POISON: logger.log(LogEvent::COMBAT_POISON, source, target, e.value); break;
+            case CombatEventType::HEAL: logger.log(LogEvent::COMBAT_HEAL, target, e.value); break;
+            case CombatEventType::DEFEAT: logger.log(LogEvent::COMBAT_DEFEAT, source, target); break;
+            case CombatEventType::LEVEL_UP: logger.log(LogEvent::COMBAT_LEVEL_UP, target, e.value); break;
+        }
+    }
+
+    void flush() override { logger.flush(); }
+};
+
+// Приёмник событий текущего потока; по умолчанию - буферизованный текст в std::cout
+CombatSink*& currentCombatSink() {
+    static TextCombatSink console(std::cout);
+    thread_local CombatSink* sink = &console;
+    return sink;
+}
+
+CombatSink& combatSink() {
+    return *currentCombatSink();
+}
+
+// Подменяет приёмник на время жизни объекта
+class ScopedCombatSink {
+    CombatSink* previous;
+
+public:
+    explicit ScopedCombatSink(CombatSink& sink) : previous(std::exchange(currentCombatSink(), &sink)) {}
+    ~ScopedCombatSink() { currentCombatSink() = previous; }
+    ScopedCombatSink(const ScopedCombatSink&) = delete;
+    ScopedCombatSink& operator=(const ScopedCombatSink&) = delete;
+};
+
+// Исход одной атаки
+struct AttackResult {
+    int damage;    // Снятое с цели здоровье: не больше её здоровья до атаки
+    bool defeated; // Цель повержена
 };
 
 // Базовый класс для всех существ
 class Entity {
 protected:
     std::string name;
+    std::uint32_t nameId;
     int health;
     int attack;
     int defense;
 
 public:
     Entity(const std::string& n, int h, int a, int d)
-        : name(n), health(h), attack(a), defense(d) {}
+        : name(n), nameId(combatNameId(n)), health(h), attack(a), defense(d) {}
 
     virtual ~Entity() = default;
 
@@ -42,22 +1111,25 @@ public:
     }
 
     int getHealth() const { return health; }
-    std::string getName() const { return name; }
+    const std::string& getName() const { return name; }
     int getAttack() const { return attack; }
     int getDefense() const { return defense; }
 
-    virtual void attackEntity(Entity& target) {
+    // Поражение цели - обычный исход боя, а не ошибка, поэтому возвращается в результате
+    virtual AttackResult attackEntity(Entity& target) {
         int damage = attack - target.getDefense();
         if (damage > 0) {
+            const int healthBefore = target.getHealth();
             target.takeDamage(damage);
-            std::cout << name << " attacks " << target.getName() << " for " << damage << " damage!\n";
+            damage = std::max(healthBefore - target.getHealth(), 0);
+            combatSink().emit({CombatEventType::ATTACK, nameId, target.nameId, damage});
         } else {
-            std::cout << name << " attacks " << target.getName() << ", but it has no effect!\n";
-        }
-        
-        if (target.getHealth() <= 0) {
-            throw std::runtime_error(target.getName() + " has been defeated!");
+            damage = 0;
+            combatSink().emit({CombatEventType::NO_EFFECT, nameId, target.nameId, 0});
         }
+        const bool defeated = target.getHealth() <= 0;
+        if (defeated) combatSink().emit({CombatEventType::DEFEAT, nameId, target.nameId, 0});
+        return {damage, defeated};
     }
 };
 
@@ -74,7 +1146,7 @@ public:
     void heal(int amount) {
         health += amount;
         if (health > 100) health = 100;
-        std::cout << name << " heals for " << amount << " HP!\n";
+        combatSink().emit({CombatEventType::HEAL, nameId, nameId, amount});
     }
 
     void gainExperience(int exp) {
@@ -82,7 +1154,7 @@ public:
         if (experience >= 100) {
             level++;
             experience -= 100;
-            std::cout << name << " leveled up to level " << level << "!\n";
+            combatSink().emit({CombatEventType::LEVEL_UP, nameId, nameId, level});
         }
     }
 
@@ -119,49 +1191,193 @@ public:
     Skeleton() : Monster("Skeleton", 40, 12, 8) {}
 };
 
+// Бой до поражения одной из сторон; true, если победил персонаж
+bool fightToEnd(Character& player, Monster& monster) {
+    while (true) {
+        if (player.attackEntity(monster).defeated) return true;
+        if (monster.attackEntity(player).defeated) return false;
+    }
+}
+
+// Пакетное разрешение атак по правилам Entity::attackEntity: урон - положительная
+// часть attack - defense; только пробившая защиту атака меняет здоровье цели и
+// поднимает отрицательное до нуля, иначе оно остаётся как есть. i-я атака - attack[i]
+// против цели с defense[i] и health[i]. Вместо исключения побеждённые цели отмечаются
+// битом i в defeated (по 64 атаки на слово); возвращается число побеждённых.
+using AttackKernel = void (*)(const std::int32_t*, const std::int32_t*, std::int32_t*,
+                              std::size_t, std::size_t, std::uint64_t*);
+
+void resolveAttacksScalar(const std::int32_t* attack, const std::int32_t* defense, std::int32_t* health,
+                          std::size_t begin, std::size_t end, std::uint64_t* defeated) {
+    for (std::size_t i = begin; i < end; ++i) {
+        // Выбор маской, а не ветвлением: пробьёт ли атака защиту, плохо предсказуемо
+        const std::int32_t damage = attack[i] - defense[i];
+        const std::int32_t hit = -static_cast<std::int32_t>(damage > 0);
+        health[i] = (std::max(health[i] - damage, 0) & hit) | (health[i] & ~hit);
+        defeated[i / 64] |= static_cast<std::uint64_t>(health[i] <= 0) << (i % 64);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse4.1")))
+void resolveAttacksSse(const std::int32_t* attack, const std::int32_t* defense, std::int32_t* health,
+                       std::size_t begin, std::size_t end, std::uint64_t* defeated) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(attack + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(defense + i));
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(health + i));
+        const __m128i damage = _mm_sub_epi32(a, d);
+        const __m128i hit = _mm_cmpgt_epi32(damage, zero);
+        h = _mm_blendv_epi8(h, _mm_max_epi32(_mm_sub_epi32(h, damage), zero), hit);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(health + i), h);
+        const auto bits = static_cast<std::uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(h, one))));
+        defeated[i / 64] |= bits << (i % 64);
+    }
+    resolveAttacksScalar(attack, defense, health, i, end, defeated);
+}
+
+__attribute__((target("avx2")))
+void resolveAttacksAvx2(const std::int32_t* attack, const std::int32_t* defense, std::int32_t* health,
+                        std::size_t begin, std::size_t end, std::uint64_t* defeated) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(attack + i));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(defense + i));
+        __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(health + i));
+        const __m256i damage = _mm256_sub_epi32(a, d);
+        const __m256i hit = _mm256_cmpgt_epi32(damage, zero);
+        h = _mm256_blendv_epi8(h, _mm256_max_epi32(_mm256_sub_epi32(h, damage), zero), hit);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(health + i), h);
+        const auto bits = static_cast<std::uint64_t>(
+            _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(one, h))));
+        defeated[i / 64] |= bits << (i % 64);
+    }
+    resolveAttacksScalar(attack, defense, health, i, end, defeated);
+}
+#endif
+
+// Лучший вариант для текущего процессора выбирается один раз при первом вызове
+AttackKernel selectAttackKernel() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return resolveAttacksAvx2;
+    if (__builtin_cpu_supports("sse4.1")) return resolveAttacksSse;
+#endif
+    return resolveAttacksScalar;
+}
+
+std::size_t resolveAttacks(const std::int32_t* attack, const std::int32_t* defense, std::int32_t* health,
+                           std::size_t n, std::uint64_t* defeated, AttackKernel kernel = nullptr) {
+    static const AttackKernel best = selectAttackKernel();
+    std::fill_n(defeated, (n + 63) / 64, 0);
+    (kernel ? kernel : best)(attack, defense, health, 0, n, defeated);
+    std::size_t count = 0;
+    for (std::size_t w = 0; w < (n + 63) / 64; ++w) {
+        count += std::popcount(defeated[w]);
+    }
+    return count;
+}
+
+// Вид существа вместо класса иерархии: в CombatStore он только метка
+enum class Archetype : std::uint8_t {
+    CHARACTER,
+    MONSTER,
+    GOBLIN,
+    DRAGON,
+    SKELETON
+};
+
+using EntityId = std::uint32_t;
+
+// Хранилище существ для массовых боёв: здоровье, атака и защита в отдельных массивах
+// по номеру существа, без объектов в куче и виртуальных вызовов. Атака следует
+// правилам Entity::attackEntity (проверяется в --check-store); события боя не
+// создаются, исход читается из массивов
+class CombatStore {
+private:
+    std::vector<std::int32_t> health;
+    std::vector<std::int32_t> attackPower;
+    std::vector<std::int32_t> defense;
+    std::vector<Archetype> archetype;
+    std::vector<std::uint32_t> nameId; // Холодные данные, в бою не читаются
+
+public:
+    void reserve(std::size_t count) {
+        health.reserve(count);
+        attackPower.reserve(count);
+        defense.reserve(count);
+        archetype.reserve(count);
+        nameId.reserve(count);
+    }
+
+    EntityId spawn(Archetype type, const std::string& name, int h, int a, int d) {
+        health.push_back(h);
+        attackPower.push_back(a);
+        defense.push_back(d);
+        archetype.push_back(type);
+        nameId.push_back(combatNameId(name));
+        return static_cast<EntityId>(health.size() - 1);
+    }
+
+    // n атак attackers[i] -> targets[i] по порядку: одна цель может встречаться в пакете
+    // несколько раз, поэтому атаки не перекладываются в resolveAttacks, где цели различны.
+    // Возвращается число атак, после которых цель повержена
+    std::size_t resolveAttacks(const EntityId* attackers, const EntityId* targets, std::size_t n) {
+        std::size_t defeated = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const EntityId t = targets[i];
+            const std::int32_t damage = attackPower[attackers[i]] - defense[t];
+            const std::int32_t hit = -static_cast<std::int32_t>(damage > 0);
+            health[t] = (std::max(health[t] - damage, 0) & hit) | (health[t] & ~hit);
+            defeated += health[t] <= 0;
+        }
+        return defeated;
+    }
+
+    std::size_t size() const { return health.size(); }
+    int getHealth(EntityId id) const { return health[id]; }
+    Archetype getArchetype(EntityId id) const { return archetype[id]; }
+    std::uint32_t getNameId(EntityId id) const { return nameId[id]; }
+};
+
 // Класс игры
 class Game {
     std::unique_ptr<Character> player;
-    Logger<std::string> logger{"game_log.txt"};
+    StructuredLogger logger{"game_log.bin", {.rotateBytes = 1 << 20, .rotateInterval = std::chrono::hours(24)}};
 
 public:
     void createCharacter() {
         std::string name;
         std::cout << "Enter character name: ";
         std::cin >> name;
-        player = std::make_unique<Character>(name, 100, (15 + rand() % 5), 10);
-        logger.log("Character created: " + name);
+        player = std::make_unique<Character>(name, 100, (15 + static_cast<int>(combatRng().below(5))), 10);
+        logger.log(LogEvent::CHARACTER_CREATED, name);
     }
 
     void battle() {
         if (!player) throw std::runtime_error("No character created!");
         
-        Monster* monster = nullptr;
-        int choice = rand() % 3;
+        std::unique_ptr<Monster> monster;
+        int choice = static_cast<int>(combatRng().below(3));
         switch(choice) {
-            case 0: monster = new Goblin(); break;
-            case 1: monster = new Dragon(); break;
-            case 2: monster = new Skeleton(); break;
+            case 0: monster = std::make_unique<Goblin>(); break;
+            case 1: monster = std::make_unique<Dragon>(); break;
+            case 2: monster = std::make_unique<Skeleton>(); break;
         }
 
-        logger.log(player->getName() + " encountered a " + monster->getName());
+        logger.log(LogEvent::ENCOUNTER, player->getName(), monster->getName());
         std::cout << "A wild " << monster->getName() << " appears!\n";
 
-        try {
-            while (true) {
-                player->attackEntity(*monster);
-                if (monster->getHealth() <= 0) {
-                    player->gainExperience(50);
-                    logger.log(player->getName() + " defeated " + monster->getName());
-                    break;
-                }
-                monster->attackEntity(*player);
-            }
-        } catch (const std::exception& e) {
-            std::cout << e.what() << "\n";
+        if (fightToEnd(*player, *monster)) {
+            player->gainExperience(50);
+            logger.log(LogEvent::MONSTER_DEFEATED, player->getName(), monster->getName());
         }
-
-        delete monster;
+        combatSink().flush();
     }
 
     void saveGame(const std::string& filename) {
@@ -175,7 +1391,7 @@ public:
              << player->getLevel() << "\n"
              << player->getExperience() << "\n";
 
-        logger.log("Game saved to " + filename);
+        logger.log(LogEvent::GAME_SAVED, filename);
     }
 
     void loadGame(const std::string& filename) {
@@ -190,7 +1406,7 @@ public:
         player->setLevel(level);
         player->setExperience(experience);
 
-        logger.log("Game loaded from " + filename);
+        logger.log(LogEvent::GAME_LOADED, filename);
     }
 
     void showMenu() {
@@ -214,7 +1430,392 @@ public:
     }
 };
 
-int main() {
+// Прежняя запись: открытие файла, запись и сброс на каждое сообщение
+void legacyLog(const std::string& filename, const std::string& message) {
+    std::ofstream file(filename, std::ios::app);
+    if (!file) throw std::runtime_error("Failed to open log file");
+    file << message << std::endl;
+}
+
+// Время одного вызова log при разных режимах логгера; сообщение собирается так же,
+// как в Game::battle
+void benchmarkLogger() {
+    const int messageCount = 200000;
+    auto directory = std::filesystem::temp_directory_path();
+    std::string filename = (directory / "lab9_bench_log.txt").string();
+    std::string binaryName = (directory / "lab9_bench_log.bin").string();
+    std::string player = "Hero";
+    std::string monster = "Goblin";
+
+    auto report = [&](const char* kind, auto&& body) {
+        std::filesystem::remove(filename);
+        std::filesystem::remove(binaryName);
+        auto start = std::chrono::steady_clock::now();
+        body();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  " << kind << ": " << elapsed.count() / messageCount << " ns per call\n";
+    };
+
+    std::cout << "Logger, " << messageCount << " messages:\n";
+    report("open/write/close per call", [&] {
+        for (int i = 0; i < messageCount; ++i) legacyLog(filename, player + " encountered a " + monster);
+    });
+    report("sync, persistent fd", [&] {
+        Logger<std::string> logger(filename, {.mode = LogMode::SYNC});
+        for (int i = 0; i < messageCount; ++i) logger.log(player + " encountered a " + monster);
+    });
+    report("async, block (incl. drain)", [&] {
+        Logger<std::string> logger(filename);
+        for (int i = 0; i < messageCount; ++i) logger.log(player + " encountered a " + monster);
+    });
+    report("async, drop (incl. drain)", [&] {
+        Logger<std::string> logger(filename, {.backpressure = Backpressure::DROP});
+        for (int i = 0; i < messageCount; ++i) logger.log(player + " encountered a " + monster);
+    });
+    report("structured, async (incl. drain)", [&] {
+        StructuredLogger logger(binaryName);
+        for (int i = 0; i < messageCount; ++i) logger.log(LogEvent::ENCOUNTER, player, monster);
+    });
+
+    // Только сборка записи: формат и аргументы против конкатенации строк
+    const int buildCount = 1000000;
+    std::size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < buildCount; ++i) sink += (player + " encountered a " + monster).size();
+    std::chrono::duration<double, std::nano> concat = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < buildCount; ++i) {
+        LogRecord record(LogEvent::ENCOUNTER);
+        record.add(player);
+        record.add(monster);
+        sink += record.bytes().size();
+    }
+    std::chrono::duration<double, std::nano> binary = std::chrono::steady_clock::now() - start;
+    std::cout << "  building a message: concatenation " << concat.count() / buildCount
+              << " ns, binary record " << binary.count() / buildCount << " ns (" << sink % 10 << ")\n";
+
+    std::filesystem::remove(filename);
+    std::filesystem::remove(binaryName);
+}
+
+// Прежний способ сообщить о поражении: исключение с именем цели
+void legacyAttack(Entity& attacker, Entity& target) {
+    attacker.attackEntity(target);
+    if (target.getHealth() <= 0) {
+        throw std::runtime_error(target.getName() + " has been defeated!");
+    }
+}
+
+// Боёв в секунду до конца: поражение через исключение против AttackResult,
+// и цена разных приёмников событий боя
+void benchmarkBattles() {
+    const int battleCount = 200000;
+    auto report = [&](const char* kind, CombatSink& sink, auto&& fight) {
+        ScopedCombatSink scoped(sink);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < battleCount; ++i) {
+            Character hero("Hero", 100, 15 + i % 5, 10);
+            Goblin goblin;
+            fight(hero, goblin);
+        }
+        sink.flush();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  " << kind << ": " << static_cast<long long>(battleCount / elapsed.count()) << " battles/s\n";
+    };
+    auto fight = [](Character& hero, Monster& monster) { fightToEnd(hero, monster); };
+
+    NullCombatSink headless;
+    std::ofstream devNull("/dev/null");
+    TextCombatSink text(devNull);
+    std::string binaryName = (std::filesystem::temp_directory_path() / "lab9_bench_combat.bin").string();
+    std::filesystem::remove(binaryName);
+
+    std::cout << "Battles to the end, " << battleCount << " fights:\n";
+    report("defeat as exception, null sink", headless, [](Character& hero, Monster& monster) {
+        try {
+            while (true) {
+                legacyAttack(hero, monster);
+                legacyAttack(monster, hero);
+            }
+        } catch (const std::runtime_error&) {
+        }
+    });
+    report("AttackResult, null sink", headless, fight);
+    report("AttackResult, text sink", text, fight);
+    {
+        BinaryCombatSink binary(binaryName);
+        report("AttackResult, binary sink", binary, fight);
+    }
+    std::filesystem::remove(binaryName);
+}
+
+// Последовательность событий одного боя проверяется через приёмник в памяти
+bool checkCombatEvents() {
+    MemoryCombatSink memory;
+    ScopedCombatSink scoped(memory);
+    Character hero("Hero", 100, 20, 10);
+    Goblin goblin; // 30 HP, атака 10, защита 5: герой бьёт на 15, гоблин не пробивает защиту
+    const bool won = fightToEnd(hero, goblin);
+    hero.gainExperience(100);
+
+    using T = CombatEventType;
+    const std::vector<T> expected = {T::ATTACK, T::NO_EFFECT, T::ATTACK, T::DEFEAT, T::LEVEL_UP};
+    std::vector<T> actual;
+    for (const auto& event : memory.getEvents()) actual.push_back(event.type);
+    const auto& events = memory.getEvents();
+    bool ok = won && actual == expected && events[0].value == 15 && events[3].target == combatNameId("Goblin") &&
+              events[4].value == 2;
+    // Добивающий удар засчитывает только оставшееся здоровье цели
+    Monster rat("Rat", 5, 0, 0);
+    const AttackResult finishing = hero.attackEntity(rat);
+    ok = ok && finishing.damage == 5 && finishing.defeated;
+    std::cout << (ok ? "Combat events and damage match the expected values\n" : "Combat event mismatch\n");
+    return ok;
+}
+
+// Бои без консоли: события отбрасываются или пишутся в двоичный файл
+void runHeadless(int battleCount, const std::string& eventFile) {
+    NullCombatSink headless;
+    std::unique_ptr<BinaryCombatSink> binary;
+    if (!eventFile.empty()) binary = std::make_unique<BinaryCombatSink>(eventFile);
+    ScopedCombatSink scoped(binary ? static_cast<CombatSink&>(*binary) : headless);
+
+    int wins = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < battleCount; ++i) {
+        Character hero("Hero", 100, 15 + static_cast<int>(combatRng().below(5)), 10);
+        std::unique_ptr<Monster> monster;
+        switch (combatRng().below(3)) {
+            case 0: monster = std::make_unique<Goblin>(); break;
+            case 1: monster = std::make_unique<Dragon>(); break;
+            default: monster = std::make_unique<Skeleton>(); break;
+        }
+        wins += fightToEnd(hero, *monster);
+    }
+    combatSink().flush();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << battleCount << " battles, " << wins << " won by the hero, " << elapsed.count() << " s\n";
+}
+
+// Сверка всех вариантов resolveAttacks с поэлементными атаками Entity::attackEntity
+// на случайных пакетах, включая длины, не кратные ширине векторов, нулевое
+// и отрицательное здоровье и атаки, не пробивающие защиту
+bool checkAttackKernels() {
+    std::vector<std::pair<const char*, AttackKernel>> kernels = {{"scalar", resolveAttacksScalar}};
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("sse4.1")) kernels.push_back({"sse4.1", resolveAttacksSse});
+    if (__builtin_cpu_supports("avx2")) kernels.push_back({"avx2", resolveAttacksAvx2});
+#endif
+
+    NullCombatSink headless;
+    std::optional<ScopedCombatSink> scoped(std::in_place, headless);
+    CombatRng rng(1); // Постоянное зерно: при расхождении пакет можно воспроизвести
+    bool ok = true;
+    for (std::size_t n : {0, 1, 3, 7, 8, 9, 63, 64, 65, 100, 1000, 4099}) {
+        std::vector<std::int32_t> attack(n), defense(n), health(n);
+        std::vector<std::int32_t> expectedHealth(n);
+        std::vector<std::uint64_t> expectedDefeated((n + 63) / 64, 0);
+        for (std::size_t i = 0; i < n; ++i) {
+            attack[i] = static_cast<std::int32_t>(rng.below(40));
+            defense[i] = static_cast<std::int32_t>(rng.below(30));
+            health[i] = static_cast<std::int32_t>(rng.below(80)) - 20;
+
+            Character attacker("A", 100, attack[i], 0);
+            Monster target("T", health[i], 0, defense[i]);
+            const bool defeated = attacker.attackEntity(target).defeated;
+            expectedHealth[i] = target.getHealth();
+            expectedDefeated[i / 64] |= static_cast<std::uint64_t>(defeated) << (i % 64);
+        }
+        for (auto& [name, kernel] : kernels) {
+            std::vector<std::int32_t> h = health;
+            std::vector<std::uint64_t> defeated((n + 63) / 64);
+            resolveAttacks(attack.data(), defense.data(), h.data(), n, defeated.data(), kernel);
+            if (h != expectedHealth || defeated != expectedDefeated) {
+                std::cerr << name << " differs from Entity::attackEntity for n = " << n << "\n";
+                ok = false;
+            }
+        }
+    }
+    scoped.reset();
+
+    const std::size_t n = 1 << 20;
+    std::vector<std::int32_t> attack(n), defense(n), health(n);
+    std::vector<std::uint64_t> defeated(n / 64);
+    for (std::size_t i = 0; i < n; ++i) {
+        attack[i] = static_cast<std::int32_t>(rng.below(40));
+        defense[i] = static_cast<std::int32_t>(rng.below(30));
+    }
+    for (auto& [name, kernel] : kernels) {
+        std::fill(health.begin(), health.end(), 1000);
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < 20; ++round) {
+            resolveAttacks(attack.data(), defense.data(), health.data(), n, defeated.data(), kernel);
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  " << name << ": " << elapsed.count() / (20.0 * n) << " ns per attack\n";
+    }
+    std::cout << (ok ? "All attack kernels match Entity::attackEntity\n" : "Attack kernel mismatch\n");
+    return ok;
+}
+
+// Одинаковый состав для объектов и CombatStore: персонажи и монстры с разными
+// характеристиками (в том числе с нулевым и отрицательным здоровьем) вперемешку
+// с гоблинами, драконами и скелетами; защита до defenseSpread + 4
+void spawnMixed(std::size_t count, int defenseSpread, std::vector<std::unique_ptr<Entity>>& objects,
+                CombatStore& store) {
+    objects.reserve(count);
+    store.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const int h = static_cast<int>(i % 70) - 10;
+        const int a = 15 + static_cast<int>(i % 20);
+        const int d = 5 + static_cast<int>(i % static_cast<std::size_t>(defenseSpread));
+        Archetype type;
+        switch (i % 8) {
+            case 0: type = Archetype::GOBLIN; objects.push_back(std::make_unique<Goblin>()); break;
+            case 1: type = Archetype::DRAGON; objects.push_back(std::make_unique<Dragon>()); break;
+            case 2: type = Archetype::SKELETON; objects.push_back(std::make_unique<Skeleton>()); break;
+            case 3:
+            case 4: type = Archetype::MONSTER; objects.push_back(std::make_unique<Monster>("Orc", h, a, d)); break;
+            default: type = Archetype::CHARACTER; objects.push_back(std::make_unique<Character>("Hero", h, a, d)); break;
+        }
+        const Entity& entity = *objects.back();
+        store.spawn(type, entity.getName(), entity.getHealth(), entity.getAttack(), entity.getDefense());
+    }
+}
+
+// Атаки attackers[i] -> targets[i]: виртуальные attackEntity по объектам в куче
+// против одного цикла CombatStore::resolveAttacks
+void benchmarkCombatStore(std::size_t count) {
+    std::vector<EntityId> attackers(count);
+    std::vector<EntityId> targets(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        attackers[i] = static_cast<EntityId>(i);
+        targets[i] = static_cast<EntityId>((i * 7919 + 1) % count);
+    }
+    std::vector<std::unique_ptr<Entity>> objects;
+    CombatStore store;
+    spawnMixed(count, 20, objects, store);
+
+    NullCombatSink headless;
+    ScopedCombatSink scoped(headless);
+    auto start = std::chrono::steady_clock::now();
+    std::size_t defeated = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        defeated += objects[attackers[i]]->attackEntity(*objects[targets[i]]).defeated;
+    }
+    std::chrono::duration<double, std::milli> virtualMs = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    const std::size_t storeDefeated = store.resolveAttacks(attackers.data(), targets.data(), count);
+    std::chrono::duration<double, std::milli> storeMs = std::chrono::steady_clock::now() - start;
+
+    std::cout << count << " attacks:\n"
+              << "  virtual attackEntity: " << virtualMs.count() << " ms (" << defeated << " defeated)\n"
+              << "  CombatStore: " << storeMs.count() << " ms (" << storeDefeated << " defeated)\n";
+}
+
+// CombatStore::resolveAttacks должен совпадать с виртуальными Entity::attackEntity
+// на тех же атаках, включая повторные удары по одной цели и уже поверженные цели
+bool checkCombatStore() {
+    const std::size_t count = 3000;
+    const std::size_t attackCount = count * 8;
+    std::vector<std::unique_ptr<Entity>> objects;
+    CombatStore store;
+    spawnMixed(count, 30, objects, store);
+
+    std::vector<EntityId> attackers(attackCount);
+    std::vector<EntityId> targets(attackCount);
+    for (std::size_t i = 0; i < attackCount; ++i) {
+        attackers[i] = static_cast<EntityId>(combatRng().below(count));
+        targets[i] = static_cast<EntityId>(combatRng().below(count));
+    }
+
+    std::size_t defeated = 0;
+    {
+        NullCombatSink headless;
+        ScopedCombatSink scoped(headless);
+        for (std::size_t i = 0; i < attackCount; ++i) {
+            defeated += objects[attackers[i]]->attackEntity(*objects[targets[i]]).defeated;
+        }
+    }
+    const bool sameCount = store.resolveAttacks(attackers.data(), targets.data(), attackCount) == defeated;
+
+    std::size_t mismatches = 0;
+    for (EntityId id = 0; id < count; ++id) {
+        mismatches += objects[id]->getHealth() != store.getHealth(id);
+    }
+    const bool ok = mismatches == 0 && sameCount;
+    if (ok) {
+        std::cout << "CombatStore matches Entity::attackEntity on " << attackCount << " attacks\n";
+    } else {
+        std::cout << "CombatStore: health differs for " << mismatches << " entities"
+                  << (sameCount ? "" : ", defeat count differs") << "\n";
+    }
+    return ok;
+}
+
+int usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--seed N] [--bench | --bench-store [n] | --check-kernels"
+              << " | --check-events | --check-store | --headless [battles] [log] | --decode log"
+              << " | --query log from to]\n";
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    // --seed N перед любым режимом делает бои воспроизводимыми
+    if (argc > 1 && std::string(argv[1]) == "--seed") {
+        std::optional<std::uint64_t> seed = argc > 2 ? parseNumber(argv[2]) : std::nullopt;
+        if (!seed) return usage(argv[0]);
+        seedCombatRng(*seed);
+        argv[2] = argv[0];
+        argc -= 2;
+        argv += 2;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        benchmarkLogger();
+        benchmarkBattles();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench-store") {
+        std::optional<std::uint64_t> count = argc > 2 ? parseNumber(argv[2]) : std::optional<std::uint64_t>(1000000);
+        if (!count || *count == 0 || *count > std::numeric_limits<EntityId>::max()) return usage(argv[0]);
+        benchmarkCombatStore(*count);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--check-kernels") {
+        return checkAttackKernels() ? 0 : 1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--check-events") {
+        return checkCombatEvents() ? 0 : 1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--check-store") {
+        return checkCombatStore() ? 0 : 1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--headless") {
+        std::optional<std::uint64_t> battles = argc > 2 ? parseNumber(argv[2]) : std::optional<std::uint64_t>(100000);
+        if (!battles || *battles > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) return usage(argv[0]);
+        runHeadless(static_cast<int>(*battles), argc > 3 ? argv[3] : "");
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--decode") {
+        try {
+            decodeLog(argv[2], std::cout);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (argc > 4 && std::string(argv[1]) == "--query") {
+        try {
+            queryLog(argv[2], parseLogTime(argv[3]), parseLogTime(argv[4]), std::cout);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
     Game game;
     game.createCharacter();
     game.showMenu();